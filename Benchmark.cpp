@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+void BenchmarkRecorder::init(const ref<Device>& pDevice)
+{
+    for (auto& pTimer : mpGpuTimers)
+        pTimer = GpuTimer::create(pDevice);
+    mCpuTimes.reserve(mConfig.frameCount);
+    mGpuTimes.reserve(mConfig.frameCount);
+}
+
+void BenchmarkRecorder::beginFrame()
+{
+    mpGpuTimers[mFrameIndex % (kGpuLatency + 1)]->begin();
+    mFrameStart = CpuTimer::getCurrentTimePoint();
+}
+
+void BenchmarkRecorder::endFrame()
+{
+    double cpuTime = CpuTimer::calcDuration(mFrameStart, CpuTimer::getCurrentTimePoint());
+    auto& pTimer = mpGpuTimers[mFrameIndex % (kGpuLatency + 1)];
+    pTimer->end();
+    pTimer->resolve();
+
+    auto isMeasured = [this](uint32_t frame) { return frame >= mConfig.warmupFrames && frame < mConfig.warmupFrames + mConfig.frameCount; };
+    if (isMeasured(mFrameIndex))
+        mCpuTimes.push_back(cpuTime);
+
+    // Read back the GPU time of an older frame, its timestamps are resolved by now.
+    if (mFrameIndex >= kGpuLatency && isMeasured(mFrameIndex - kGpuLatency))
+        mGpuTimes.push_back(mpGpuTimers[(mFrameIndex - kGpuLatency) % (kGpuLatency + 1)]->getElapsedTime());
+
+    mFrameIndex++;
+}
+
+BenchmarkRecorder::Stats BenchmarkRecorder::computeStats(std::vector<double> samples)
+{
+    Stats stats;
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p)
+    {
+        // Nearest-rank percentile.
+        size_t rank = (size_t)std::ceil(p / 100.0 * samples.size());
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p95 = percentile(95);
+    stats.p99 = percentile(99);
+    return stats;
+}
+
+void BenchmarkRecorder::writeReport(uint2 frameDim) const
+{
+    std::filesystem::path path = mConfig.outputPath;
+    if (path.empty())
+        path = mConfig.sampleName + "_benchmark.json";
+
+    std::ofstream os(path);
+    if (!os)
+        FALCOR_THROW("Failed to open benchmark report '{}' for writing.", path.string());
+
+    if (path.extension() == ".csv")
+        writeCsv(os);
+    else
+        writeJson(os, frameDim);
+
+    Stats cpu = computeStats(mCpuTimes);
+    Stats gpu = computeStats(mGpuTimes);
+    logInfo(
+        "Benchmark '{}' ({} frames at {}x{}): CPU mean {:.3f} ms p99 {:.3f} ms, GPU mean {:.3f} ms p99 {:.3f} ms. Report written to '{}'.",
+        mConfig.sampleName,
+        mCpuTimes.size(),
+        frameDim.x,
+        frameDim.y,
+        cpu.mean,
+        cpu.p99,
+        gpu.mean,
+        gpu.p99,
+        path.string()
+    );
+}
+
+void BenchmarkRecorder::writeJson(std::ostream& os, uint2 frameDim) const
+{
+    auto writeStats = [&](const char* name, const Stats& s)
+    {
+        os << "    \"" << name << "\": { \"mean\": " << s.mean << ", \"min\": " << s.min << ", \"max\": " << s.max << ", \"p50\": " << s.p50
+           << ", \"p90\": " << s.p90 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << " },\n";
+    };
+    auto writeArray = [&](const char* name, const std::vector<double>& v, bool last)
+    {
+        os << "    \"" << name << "\": [";
+        for (size_t i = 0; i < v.size(); i++)
+            os << (i ? ", " : "") << v[i];
+        os << "]" << (last ? "\n" : ",\n");
+    };
+
+    os << "{\n";
+    os << "    \"sample\": \"" << mConfig.sampleName << "\",\n";
+    os << "    \"width\": " << frameDim.x << ",\n";
+    os << "    \"height\": " << frameDim.y << ",\n";
+    os << "    \"warmupFrames\": " << mConfig.warmupFrames << ",\n";
+    os << "    \"frames\": " << mCpuTimes.size() << ",\n";
+    writeStats("cpuMs", computeStats(mCpuTimes));
+    writeStats("gpuMs", computeStats(mGpuTimes));
+    writeArray("cpuFrameMs", mCpuTimes, false);
+    writeArray("gpuFrameMs", mGpuTimes, true);
+    os << "}\n";
+}
+
+void BenchmarkRecorder::writeCsv(std::ostream& os) const
+{
+    os << "frame,cpuMs,gpuMs\n";
+    for (size_t i = 0; i < mCpuTimes.size(); i++)
+        os << i << "," << mCpuTimes[i] << "," << (i < mGpuTimes.size() ? mGpuTimes[i] : 0.0) << "\n";
+
+    // Summary rows, so a single file is enough for regression tracking.
+    Stats cpu = computeStats(mCpuTimes);
+    Stats gpu = computeStats(mGpuTimes);
+    os << "mean," << cpu.mean << "," << gpu.mean << "\n";
+    os << "min," << cpu.min << "," << gpu.min << "\n";
+    os << "max," << cpu.max << "," << gpu.max << "\n";
+    os << "p50," << cpu.p50 << "," << gpu.p50 << "\n";
+    os << "p90," << cpu.p90 << "," << gpu.p90 << "\n";
+    os << "p95," << cpu.p95 << "," << gpu.p95 << "\n";
+    os << "p99," << cpu.p99 << "," << gpu.p99 << "\n";
+}
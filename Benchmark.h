@@ -0,0 +1,96 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/SampleApp.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/GpuTimer.h"
+
+using namespace Falcor;
+
+struct BenchmarkConfig
+{
+    std::string sampleName;            ///< Name of the benchmarked sample class, written into the report.
+    uint32_t frameCount = 0;           ///< Number of measured frames. 0 disables benchmark mode.
+    uint32_t warmupFrames = 16;        ///< Frames rendered before measuring starts (shader compilation, history buffers...).
+    std::filesystem::path outputPath;  ///< Report file. The extension selects the format (.json or .csv).
+};
+
+/** Records per-frame CPU and GPU times and writes them out with summary percentiles.
+ */
+class BenchmarkRecorder
+{
+public:
+    struct Stats
+    {
+        double mean = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    BenchmarkRecorder(const BenchmarkConfig& config) : mConfig(config) {}
+
+    void init(const ref<Device>& pDevice);
+    void beginFrame();
+    void endFrame();
+    bool isDone() const { return mFrameIndex >= mConfig.warmupFrames + mConfig.frameCount + kGpuLatency; }
+    void writeReport(uint2 frameDim) const;
+    Stats getCpuStats() const { return computeStats(mCpuTimes); }
+    Stats getGpuStats() const { return computeStats(mGpuTimes); }
+
+    static Stats computeStats(std::vector<double> samples);
+
+private:
+    /// GPU times are read back with this many frames of latency so measuring does not stall the queue.
+    static const uint32_t kGpuLatency = 2;
+
+    void writeJson(std::ostream& os, uint2 frameDim) const;
+    void writeCsv(std::ostream& os) const;
+
+    BenchmarkConfig mConfig;
+    ref<GpuTimer> mpGpuTimers[kGpuLatency + 1];
+    CpuTimer::TimePoint mFrameStart;
+    uint32_t mFrameIndex = 0;
+    std::vector<double> mCpuTimes;
+    std::vector<double> mGpuTimes;
+};
+
+/** Wraps any sample class and runs it as a fixed-length benchmark.
+    The sample renders exactly as it does interactively, the wrapper only adds timing around onFrameRender
+    and shuts the app down once all frames are recorded.
+ */
+template<typename T>
+class Benchmark : public T
+{
+public:
+    Benchmark(const SampleAppConfig& config, const BenchmarkConfig& benchmarkConfig) : T(config), mRecorder(benchmarkConfig) {}
+
+    void onLoad(RenderContext* pRenderContext) override
+    {
+        T::onLoad(pRenderContext);
+        mRecorder.init(this->getDevice());
+    }
+
+    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override
+    {
+        if (mDone)
+            return;
+
+        mRecorder.beginFrame();
+        T::onFrameRender(pRenderContext, pTargetFbo);
+        mRecorder.endFrame();
+
+        if (mRecorder.isDone())
+        {
+            mRecorder.writeReport(uint2(pTargetFbo->getWidth(), pTargetFbo->getHeight()));
+            mDone = true;
+            this->shutdown();
+        }
+    }
+
+private:
+    BenchmarkRecorder mRecorder;
+    bool mDone = false;
+};
@@ -0,0 +1,74 @@
+#include "BinaryMesh.h"
+#include <fstream>
+
+namespace
+{
+const uint64_t kBlobAlignment = 64;
+
+uint64_t alignBlob(uint64_t offset)
+{
+    return (offset + kBlobAlignment - 1) & ~(kBlobAlignment - 1);
+}
+} // namespace
+
+void BinaryMesh::write(
+    const std::filesystem::path& path,
+    uint32_t vertexLayout,
+    const void* pVertices,
+    uint32_t vertexStride,
+    uint32_t vertexCount,
+    const void* pIndices,
+    uint32_t indexStride,
+    uint32_t indexCount,
+    const float3& positionScale,
+    const float3& positionOffset
+)
+{
+    Header header{kMagic, kVersion, vertexLayout, vertexStride, vertexCount, indexCount, indexStride, 0, 0, 0};
+    for (int i = 0; i < 3; i++)
+    {
+        header.positionScale[i] = positionScale[i];
+        header.positionOffset[i] = positionOffset[i];
+    }
+    header.vertexOffset = alignBlob(sizeof(Header));
+    header.indexOffset = alignBlob(header.vertexOffset + (uint64_t)vertexStride * vertexCount);
+
+    std::ofstream os(path, std::ios::binary);
+    if (!os)
+        FALCOR_THROW("Failed to open binary mesh '{}' for writing.", path.string());
+
+    const char padding[kBlobAlignment] = {};
+    auto writeAt = [&](uint64_t offset, const void* pData, uint64_t size)
+    {
+        os.write(padding, offset - (uint64_t)os.tellp());
+        os.write(static_cast<const char*>(pData), size);
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.vertexOffset, pVertices, (uint64_t)vertexStride * vertexCount);
+    writeAt(header.indexOffset, pIndices, (uint64_t)indexCount * indexStride);
+    if (!os)
+        FALCOR_THROW("Failed to write binary mesh '{}'.", path.string());
+}
+
+bool BinaryMesh::isCurrentVersion(const std::filesystem::path& path)
+{
+    std::ifstream is(path, std::ios::binary);
+    uint32_t start[2] = {};
+    is.read(reinterpret_cast<char*>(start), sizeof(start));
+    return is && start[0] == kMagic && start[1] == kVersion;
+}
+
+BinaryMesh::BinaryMesh(const std::filesystem::path& path) : mFile(path, MemoryMappedFile::WholeFile, MemoryMappedFile::AccessHint::SequentialScan)
+{
+    if (!mFile.isOpen())
+        FALCOR_THROW("Failed to map binary mesh '{}'.", path.string());
+
+    size_t size = mFile.getSize();
+    mpHeader = static_cast<const Header*>(mFile.getData());
+    if (size < sizeof(Header) || mpHeader->magic != kMagic || mpHeader->version != kVersion)
+        FALCOR_THROW("'{}' is not a binary mesh of version {}.", path.string(), kVersion);
+    if (mpHeader->vertexOffset + (uint64_t)mpHeader->vertexStride * mpHeader->vertexCount > size ||
+        (mpHeader->indexStride != 2 && mpHeader->indexStride != 4) ||
+        mpHeader->indexOffset + (uint64_t)mpHeader->indexCount * mpHeader->indexStride > size)
+        FALCOR_THROW("Binary mesh '{}' is truncated.", path.string());
+}
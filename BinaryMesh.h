@@ -0,0 +1,60 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+using namespace Falcor;
+
+/** Flat binary mesh container (.fmesh), written offline by MeshCache::convert() and memory-mapped at load.
+    The file is a Header followed by the vertex blob at vertexOffset and the index blob at indexOffset,
+    both already in the GPU upload layout of the header's vertex layout, so they go to the buffer upload as is.
+ */
+class BinaryMesh
+{
+public:
+    static const uint32_t kMagic = 0x48534d46; // "FMSH"
+    /// 4: positionScale is the extent of the bounds, the unorm16 positions are dequantized in [0, 1].
+    static const uint32_t kVersion = 4;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexLayout; ///< MeshVertexLayout
+        uint32_t vertexStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t indexStride; ///< 2 or 4 bytes.
+        uint32_t reserved;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        float positionScale[3]; ///< Dequantization of compressed positions, see MeshCache::Mesh.
+        float positionOffset[3];
+    };
+
+    static void write(
+        const std::filesystem::path& path,
+        uint32_t vertexLayout,
+        const void* pVertices,
+        uint32_t vertexStride,
+        uint32_t vertexCount,
+        const void* pIndices,
+        uint32_t indexStride,
+        uint32_t indexCount,
+        const float3& positionScale,
+        const float3& positionOffset
+    );
+
+    /// Whether `path` starts with the header of this version, without mapping the file.
+    static bool isCurrentVersion(const std::filesystem::path& path);
+
+    /// Maps the file. Throws if it is not a valid container.
+    BinaryMesh(const std::filesystem::path& path);
+
+    const Header& getHeader() const { return *mpHeader; }
+    const void* getVertexData() const { return static_cast<const uint8_t*>(mFile.getData()) + mpHeader->vertexOffset; }
+    const void* getIndexData() const { return static_cast<const uint8_t*>(mFile.getData()) + mpHeader->indexOffset; }
+
+private:
+    MemoryMappedFile mFile;
+    const Header* mpHeader = nullptr;
+};
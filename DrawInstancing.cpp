@@ -1,49 +1,50 @@
 #include "DrawInstancing.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/UI/TextRenderer.h"
+#include <fstream>
 
 using namespace Falcor::math;
 
-DrawInstancing::DrawInstancing(const SampleAppConfig& config) : SampleApp(config) {}
+namespace
+{
+const uint32_t kMaxInstanceCount = 1 << 21;
+const uint32_t kSweepCounts[] = {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20, 1 << 21};
+const uint32_t kSweepWarmupFrames = 16;
+const uint32_t kSweepFrames = 64;
 
-DrawInstancing::~DrawInstancing() {}
+// Bounding sphere of TriangleMesh::createCube(), a unit cube around the origin.
+const float kCubeBoundingRadius = 0.8660254f;
 
-ref<Vao> DrawInstancing::createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh)
+/// D3D12 / Vulkan layout of the arguments of an indexed indirect draw.
+struct DrawIndexedArguments
 {
-    ref<VertexLayout> pLayout = VertexLayout::create();
-
-    // Add the packed static vertex data layout.
-    ref<VertexBufferLayout> pVertexLayout = VertexBufferLayout::create();
-    pVertexLayout->addElement(
-        VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC
-    );
-    pVertexLayout->addElement(
-        VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME,
-        offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius),
-        ResourceFormat::RGB32Float,
-        1,
-        VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
-    );
-    pVertexLayout->addElement(
-        VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC
-    );
-    pLayout->addBufferLayout(0, pVertexLayout);
-    ref<Buffer> pVertexBuffer;
-    const TriangleMesh::VertexList& vertices = mesh->getVertices();
-    uint32_t vertexCount = vertices.size();
-    ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
-    pVertexBuffer = device->createStructuredBuffer(
-        sizeof(PackedStaticVertexData), vertexCount, vbBindFlags, MemoryType::DeviceLocal, vertices.data(), false
-    );
-    const TriangleMesh::IndexList& indices = mesh->getIndices();
-    uint32_t indexCount = indices.size();
-    auto indexBuffer = device->createTypedBuffer<uint32_t>(
-        indexCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::Index, MemoryType::DeviceLocal, indices.data()
-    );
+    uint32_t indexCountPerInstance;
+    uint32_t instanceCount;
+    uint32_t startIndexLocation;
+    int32_t baseVertexLocation;
+    uint32_t startInstanceLocation;
+};
 
-    // Create VAO
-    return Vao::create(Vao::Topology::TriangleList, pLayout, {pVertexBuffer}, indexBuffer, ResourceFormat::R32Uint);
+/// World space planes of the frustum of `viewProj` (Gribb and Hartmann), normalized, pointing inside.
+void extractFrustumPlanes(const float4x4& viewProj, float4 planes[6])
+{
+    float4 r0 = viewProj.getRow(0), r1 = viewProj.getRow(1), r2 = viewProj.getRow(2), r3 = viewProj.getRow(3);
+    planes[0] = r3 + r0; // left
+    planes[1] = r3 - r0; // right
+    planes[2] = r3 + r1; // bottom
+    planes[3] = r3 - r1; // top
+    planes[4] = r2;      // near, z in [0, 1]
+    planes[5] = r3 - r2; // far
+    for (int i = 0; i < 6; i++)
+        planes[i] /= length(float3(planes[i].x, planes[i].y, planes[i].z));
 }
+} // namespace
+
+std::filesystem::path DrawInstancing::sSweepOutputPath;
+
+DrawInstancing::DrawInstancing(const SampleAppConfig& config) : SampleApp(config) {}
+
+DrawInstancing::~DrawInstancing() {}
 
 void DrawInstancing::onLoad(RenderContext* pRenderContext)
 {
@@ -53,9 +54,8 @@ void DrawInstancing::onLoad(RenderContext* pRenderContext)
     mpProgram = Program::createGraphics(device, "Samples/SampleAppTemplate/DrawInstancing.slang", "vsMain", "psMain");
     mpVars = ProgramVars::create(device, mpProgram->getReflector());
 
-    tringleMesh = TriangleMesh::createCube();
-    // Create VAO
-    mpVao = createVao(device, tringleMesh);
+    mpMeshCache = MeshCache::get(device);
+    mpVao = mpMeshCache->getVao(MeshCache::kCube, MeshVertexLayout::Standard);
 
     DepthStencilState::Desc depthDesc;
     mpDepthStencil = DepthStencilState::create(depthDesc);
@@ -81,33 +81,232 @@ void DrawInstancing::onLoad(RenderContext* pRenderContext)
     projectionMatrix = math::perspective(math::radians(60.0f), 16.0f / 9.0f, near, far);
     viewMatrix = math::matrixFromLookAt(float3(1, 2, 3), float3(), float3(0.0f, 1.0f, 0.0f));
     VP = mul(projectionMatrix, viewMatrix);
+    mPrevVP = VP;
+
+    mpCullPass = ComputePass::create(device, "Samples/SampleAppTemplate/InstanceCulling.cs.slang", "main");
+    mpHiZ = std::make_unique<HiZPyramid>(device);
+    mpDrawArgsBuffer = device->createBuffer(
+        sizeof(DrawIndexedArguments), ResourceBindFlags::UnorderedAccess | ResourceBindFlags::IndirectArg, MemoryType::DeviceLocal, nullptr
+    );
+    for (auto& pReadback : mpVisibleCountReadback)
+        pReadback = device->createBuffer(sizeof(uint32_t), ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
+    mpRasterFbo = Fbo::create(device);
+
+    if (!sSweepOutputPath.empty())
+        startSweep();
+}
+
+void DrawInstancing::updateInstances(RenderContext* pRenderContext)
+{
+    if (mInstances.getCount() != instanceCount || mInstances.getExtent() != mGridExtent)
+    {
+        mInstances.resize(instanceCount, mGridExtent);
+        mInstancesDirty = true;
+    }
+    if (!mAnimate && !mInstancesDirty)
+        return;
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    mInstances.update((float)getGlobalClock().getTime());
+    const auto& data = mInstances.getInstanceData();
+    if (!mpInstanceBuffer || mpInstanceBuffer->getElementCount() < instanceCount)
+    {
+        // Grown in powers of two, so the sweep and the slider do not reallocate every step.
+        uint32_t capacity = 1024;
+        while (capacity < instanceCount)
+            capacity *= 2;
+        mpInstanceBuffer = getDevice()->createStructuredBuffer(
+            sizeof(InstanceStore::InstanceData), capacity, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false
+        );
+        mpVisibleBuffer = getDevice()->createStructuredBuffer(
+            sizeof(uint32_t), capacity, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false
+        );
+    }
+    mpInstanceBuffer->setBlob(data.data(), 0, data.size() * sizeof(InstanceStore::InstanceData));
+    mUpdateMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    mInstancesDirty = false;
+}
+
+void DrawInstancing::cullInstances(RenderContext* pRenderContext)
+{
+    FALCOR_PROFILE(pRenderContext, "cullInstances");
+
+    DrawIndexedArguments args = {mpVao->getIndexBuffer()->getElementCount(), 0, 0, 0, 0};
+    mpDrawArgsBuffer->setBlob(&args, 0, sizeof(args));
+
+    // The pyramid is from the previous frame: objects that just came out from behind an occluder show up a frame late.
+    bool occlusionCulling = mOcclusionCulling && mpHiZ->isValid();
+    const ref<Texture>& pHiZ = occlusionCulling ? mpHiZ->getTexture() : mpRasterFbo->getDepthStencilTexture();
+
+    float4 planes[6];
+    extractFrustumPlanes(VP, planes);
+    ShaderVar var = mpCullPass->getRootVar();
+    var["CullCB"]["gWorld"] = modelMatrix;
+    var["CullCB"]["gPrevViewProj"] = mPrevVP;
+    for (int i = 0; i < 6; i++)
+        var["CullCB"]["gFrustumPlanes"][i] = planes[i];
+    var["CullCB"]["gBoundingRadius"] = kCubeBoundingRadius;
+    var["CullCB"]["gInstanceCount"] = instanceCount;
+    var["CullCB"]["gFrustumCulling"] = mFrustumCulling ? 1u : 0u;
+    var["CullCB"]["gOcclusionCulling"] = occlusionCulling ? 1u : 0u;
+    var["CullCB"]["gHiZSize"] = uint2(pHiZ->getWidth(), pHiZ->getHeight());
+    var["CullCB"]["gHiZMipCount"] = pHiZ->getMipCount();
+    var["gInstances"] = mpInstanceBuffer;
+    var["gVisibleInstances"] = mpVisibleBuffer;
+    var["gDrawArgs"] = mpDrawArgsBuffer;
+    var["gHiZ"] = pHiZ;
+    mpCullPass->execute(pRenderContext, uint3(instanceCount, 1, 1));
+
+    // Read back the visible count of an older frame, its copy has completed by now.
+    uint32_t slot = mFrameIndex % (kReadbackLatency + 1);
+    if (mFrameIndex >= kReadbackLatency)
+    {
+        const auto& pOldest = mpVisibleCountReadback[(mFrameIndex + 1) % (kReadbackLatency + 1)];
+        mVisibleCount = *static_cast<const uint32_t*>(pOldest->map(Buffer::MapType::Read));
+        pOldest->unmap();
+    }
+    pRenderContext->copyBufferRegion(
+        mpVisibleCountReadback[slot].get(), 0, mpDrawArgsBuffer.get(), offsetof(DrawIndexedArguments, instanceCount), sizeof(uint32_t)
+    );
+    mFrameIndex++;
+}
+
+void DrawInstancing::startSweep()
+{
+    mInstanceCountBeforeSweep = instanceCount;
+    mSweepResults.clear();
+    mSweepStep = 0;
+    mpSweepRecorder.reset();
+    advanceSweep();
+}
+
+void DrawInstancing::advanceSweep()
+{
+    if (mpSweepRecorder)
+    {
+        mSweepResults.push_back(
+            {instanceCount, mVisibleCount, mSweepUpdateMs / std::max(1u, mSweepFrameCount), mpSweepRecorder->getCpuStats(), mpSweepRecorder->getGpuStats()}
+        );
+        const SweepPoint& point = mSweepResults.back();
+        logInfo(
+            "Instancing sweep: {} instances, {} visible, update {:.3f} ms, CPU {:.3f} ms, GPU {:.3f} ms (medians).",
+            point.instanceCount,
+            point.visibleCount,
+            point.updateMs,
+            point.cpu.p50,
+            point.gpu.p50
+        );
+        mSweepStep++;
+    }
+
+    if (mSweepStep == std::size(kSweepCounts))
+    {
+        mpSweepRecorder.reset();
+        instanceCount = mInstanceCountBeforeSweep;
+        std::filesystem::path path = sSweepOutputPath.empty() ? "DrawInstancing_sweep.csv" : sSweepOutputPath;
+        writeSweep(path);
+        if (!sSweepOutputPath.empty())
+            shutdown();
+        return;
+    }
+
+    BenchmarkConfig config;
+    config.sampleName = "DrawInstancing";
+    config.frameCount = kSweepFrames;
+    config.warmupFrames = kSweepWarmupFrames;
+    mpSweepRecorder = std::make_unique<BenchmarkRecorder>(config);
+    mpSweepRecorder->init(getDevice());
+    mSweepUpdateMs = 0.0;
+    mSweepFrameCount = 0;
+    instanceCount = kSweepCounts[mSweepStep];
+}
+
+void DrawInstancing::writeSweep(const std::filesystem::path& path) const
+{
+    std::ofstream os(path);
+    if (!os)
+    {
+        logWarning("Failed to write the instancing sweep to '{}'.", path.string());
+        return;
+    }
+    os << "instances,visible,update_ms,cpu_mean_ms,cpu_p50_ms,cpu_p95_ms,gpu_mean_ms,gpu_p50_ms,gpu_p95_ms\n";
+    for (const auto& point : mSweepResults)
+    {
+        os << point.instanceCount << "," << point.visibleCount << "," << point.updateMs << "," << point.cpu.mean << "," << point.cpu.p50 << "," << point.cpu.p95
+           << "," << point.gpu.mean << "," << point.gpu.p50 << "," << point.gpu.p95 << "\n";
+    }
+    logInfo("Wrote the instancing sweep to '{}'.", path.string());
 }
 
 void DrawInstancing::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
 {
-    pRenderContext->clearFbo(pTargetFbo.get(), float4(0.2f), 1.f, 0);
-    mpGraphicsState->setFbo(pTargetFbo);
+    if (mpSweepRecorder)
+        mpSweepRecorder->beginFrame();
+
+    if (mpRasterFbo->getWidth() != pTargetFbo->getWidth() || mpRasterFbo->getHeight() != pTargetFbo->getHeight())
+    {
+        // The depth buffer is read back into the Hi-Z pyramid, so the sample renders into its own FBO.
+        uint32_t width = pTargetFbo->getWidth(), height = pTargetFbo->getHeight();
+        mpRasterFbo->attachColorTarget(
+            getDevice()->createTexture2D(
+                width, height, ResourceFormat::RGBA8UnormSrgb, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
+            ),
+            0
+        );
+        mpRasterFbo->attachDepthStencilTarget(getDevice()->createTexture2D(
+            width, height, ResourceFormat::D32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::DepthStencil
+        ));
+    }
+
+    updateInstances(pRenderContext);
+    modelMatrix = math::rotate(modelMatrix, math::radians(0.25f), float3(0, 1, 0));
+    cullInstances(pRenderContext);
+
+    pRenderContext->clearFbo(mpRasterFbo.get(), float4(0.2f), 1.f, 0);
+    mpGraphicsState->setFbo(mpRasterFbo);
     mpGraphicsState->setVao(mpVao);
     mpGraphicsState->setDepthStencilState(mpDepthStencil);
     mpGraphicsState->setRasterizerState(mpRasterizeState);
     mpGraphicsState->setProgram(mpProgram);
     ShaderVar var = mpVars->getRootVar();
 
-    modelMatrix = math::rotate(modelMatrix, math::radians(0.25f), float3(0, 1, 0));
     var["gSampler"] = gSampler;
     var["PerFrameCB"][kViewProjMatrices] = VP;
     var["PerFrameCB"][kWorldMatrices] = modelMatrix;
     var["PerFrameCB"][kInverseTransposeWorldMatrices] = transpose(inverse(modelMatrix));
     var["PerFrameCB"]["diffuse"] = mpDiffuseMap;
-    var["PerFrameCB"]["instanceCount"] = instanceCount;
-    var["PerFrameCB"]["time"] = (float)getGlobalClock().getTime();
+    var["gInstances"] = mpInstanceBuffer;
+    var["gVisibleInstances"] = mpVisibleBuffer;
+
+    // Vertex work scales with the visible instances only, the instance count comes from the culling pass.
+    pRenderContext->drawIndexedIndirect(mpGraphicsState.get(), mpVars.get(), 1, mpDrawArgsBuffer.get(), 0, nullptr, 0);
+
+    mpHiZ->build(pRenderContext, mpRasterFbo->getDepthStencilTexture());
+    mPrevVP = VP;
+    pRenderContext->blit(mpRasterFbo->getColorTexture(0)->getSRV(), pTargetFbo->getRenderTargetView(0));
 
-    //pRenderContext->drawIndexed(mpGraphicsState.get(), mpVars.get(), mpVao->getIndexBuffer()->getElementCount(), 0, 0);
-    pRenderContext->drawIndexedInstanced(mpGraphicsState.get(), mpVars.get(), mpVao->getIndexBuffer()->getElementCount(), instanceCount, 0, 0, 0);
+    if (mpSweepRecorder)
+    {
+        mpSweepRecorder->endFrame();
+        mSweepUpdateMs += mUpdateMs;
+        mSweepFrameCount++;
+        if (mpSweepRecorder->isDone())
+            advanceSweep();
+    }
 }
 
 void DrawInstancing::onGuiRender(Gui* pGui)
 {
     Gui::Window w(pGui, "PBR Settings", {300, 400}, {10, 80});
-    w.slider("Instance Count", instanceCount, (uint32_t)1, (uint32_t)1000);
+    w.slider("Instance Count", instanceCount, (uint32_t)1, kMaxInstanceCount);
+    w.slider("Grid extent", mGridExtent, 3.0f, 200.0f);
+    w.checkbox("Animate", mAnimate);
+    w.checkbox("Frustum culling", mFrustumCulling);
+    w.checkbox("Occlusion culling (Hi-Z)", mOcclusionCulling);
+    w.text(fmt::format("Visible instances: {} of {}", mVisibleCount, instanceCount));
+    w.text(fmt::format("Instance update and upload: {:.2f} ms", mUpdateMs));
+    if (mpSweepRecorder)
+        w.text(fmt::format("Sweeping {} of {}...", mSweepStep + 1, std::size(kSweepCounts)));
+    else if (w.button("Run sweep"))
+        startSweep();
 }
@@ -2,7 +2,11 @@
 #include "Falcor.h"
 #include "Core/SampleApp.h"
 #include "Core/Pass/RasterPass.h"
-#include <Scene/TriangleMesh.h>
+#include "Core/Pass/ComputePass.h"
+#include "MeshCache.h"
+#include "InstanceStore.h"
+#include "HiZPyramid.h"
+#include "Benchmark.h"
 using namespace Falcor;
 
 class DrawInstancing : public SampleApp
@@ -15,14 +19,31 @@ public:
     void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
     void onGuiRender(Gui* pGui) override;
 
+    /// Set from the command line: run the instance count sweep on load, write it to this CSV file and exit.
+    static std::filesystem::path sSweepOutputPath;
+
 private:
+    struct SweepPoint
+    {
+        uint32_t instanceCount;
+        uint32_t visibleCount;
+        double updateMs; ///< Mean CPU time of the instance store update and upload.
+        BenchmarkRecorder::Stats cpu;
+        BenchmarkRecorder::Stats gpu;
+    };
+
+    void updateInstances(RenderContext* pRenderContext);
+    void cullInstances(RenderContext* pRenderContext);
+    void startSweep();
+    void advanceSweep();
+    void writeSweep(const std::filesystem::path& path) const;
+
     static const float4 kClearColor;
     const std::string kViewProjMatrices = "viewProjMatrices";
     const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
     const std::string kWorldMatrices = "worldMatrices";
-    static ref<Vao> createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh);
-    ref<TriangleMesh> tringleMesh;
     ref<Vao> mpVao;
+    std::shared_ptr<MeshCache> mpMeshCache;
     ref<Program> mpProgram;
     ref<ProgramVars> mpVars;
     ref<GraphicsState> mpGraphicsState;
@@ -34,5 +55,35 @@ private:
     float4x4 projectionMatrix;
     float4x4 viewMatrix;
     float4x4 VP;
-    uint32_t instanceCount = 10;
+    uint32_t instanceCount = 1000;
+
+    InstanceStore mInstances;
+    ref<Buffer> mpInstanceBuffer;
+    bool mAnimate = true;
+    bool mInstancesDirty = true;
+    double mUpdateMs = 0.0;
+    float mGridExtent = 3.0f;
+
+    // GPU culling: instances surviving the frustum and Hi-Z tests are appended to mpVisibleBuffer, whose count goes
+    // straight into the indirect draw arguments.
+    static const uint32_t kReadbackLatency = 2;
+    ref<Fbo> mpRasterFbo;
+    ref<ComputePass> mpCullPass;
+    std::unique_ptr<HiZPyramid> mpHiZ;
+    ref<Buffer> mpVisibleBuffer;
+    ref<Buffer> mpDrawArgsBuffer;
+    ref<Buffer> mpVisibleCountReadback[kReadbackLatency + 1];
+    float4x4 mPrevVP;
+    uint64_t mFrameIndex = 0;
+    uint32_t mVisibleCount = 0;
+    bool mFrustumCulling = true;
+    bool mOcclusionCulling = true;
+
+    // Frame time sweep across instance counts, one BenchmarkRecorder per count.
+    std::unique_ptr<BenchmarkRecorder> mpSweepRecorder;
+    size_t mSweepStep = 0;
+    double mSweepUpdateMs = 0.0;
+    uint32_t mSweepFrameCount = 0;
+    uint32_t mInstanceCountBeforeSweep = 0;
+    std::vector<SweepPoint> mSweepResults;
 };
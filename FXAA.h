@@ -5,24 +5,25 @@
 
 using namespace Falcor;
 
-class FXAA : public GBuffer
+/// FXAA, one node "FXAA" (color -> color).
+class FXAATechnique : public GBufferTechnique
 {
 public:
-    FXAA(const SampleAppConfig& config);
-    ~FXAA();
-
-    void onLoad(RenderContext* pRenderContext) override;
-    void onShutdown() override;
-    void onResize(uint32_t width, uint32_t height) override;
-    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
+    std::string getName() const override { return "FXAA"; }
+    void onLoad(const ref<Device>& pDevice, TechniqueGraph& graph) override;
     void onGuiRender(Gui* pGui) override;
-    bool onKeyEvent(const KeyboardEvent& keyEvent) override;
-    bool onMouseEvent(const MouseEvent& mouseEvent) override;
-    void onHotReload(HotReloadFlags reloaded) override;
-    void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo);
+
+    bool enableFXAA = true;
 
 private:
     ref<FullScreenPass> mpFullScreenPass;
+    ref<Fbo> mpFxaaFbo;
     float rcpX = 0.1f, rcpY = 0.1f;
-    bool enableFXAA = true;
+};
+
+class FXAA : public GBuffer
+{
+public:
+    FXAA(const SampleAppConfig& config);
+    ~FXAA();
 };
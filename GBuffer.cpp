@@ -17,6 +17,27 @@ const ChannelList GBuffer::kGBufferChannels = {
     //{ "mtlData",        "gMaterialData",    "Material data (ID, header.x, header.y, lobes)",     true /* optional */, ResourceFormat::RGBA32Uint  },
     // clang-format on
 };
+const ChannelList GBuffer::kCompactGBufferChannels = {
+    // clang-format off
+    { "color",          "gColor",           "Final result",                                      true /* optional */, ResourceFormat::RGBA16Float },
+    { "posW",           "gPosW",            "Position in world space, reconstructed from depth", true /* optional */, ResourceFormat::Unknown     },
+    { "normW",          "gNormW",           "Shading normal in world space, octahedral",         true /* optional */, ResourceFormat::RG16Snorm   },
+    { "tangentW",       "gTangentW",        "Shading tangent in world space (xyz) and sign (w)", true /* optional */, ResourceFormat::RGBA16Float },
+    { "faceNormalW",    "gFaceNormalW",     "Face normal in world space, octahedral",            true /* optional */, ResourceFormat::RG16Snorm   },
+    { "mvec",           "gMotionVector",    "Motion vector in clip space",                       true /* optional */, ResourceFormat::RG16Float   },
+    // clang-format on
+};
+GBufferLayout GBuffer::sDefaultLayout = GBufferLayout::Full;
+float GBuffer::sDefaultRenderScale = 1.0f;
+
+namespace
+{
+const Gui::DropdownList kGBufferLayoutDropdown = {
+    {(uint32_t)GBufferLayout::Full, "Full"},
+    {(uint32_t)GBufferLayout::Compact, "Compact"},
+};
+} // namespace
+
 GBuffer::GBuffer(const SampleAppConfig& config) : SampleApp(config)
 {
     screenHeight = config.windowDesc.height;
@@ -31,20 +52,20 @@ GBuffer::~GBuffer()
 void GBuffer::onLoad(RenderContext* pRenderContext)
 {
     mpFbo = Fbo::create(getDevice());
-
-    float height = getConfig().windowDesc.height;
-    float width = getConfig().windowDesc.width;
-    for (int i = 0; i < kGBufferChannels.size(); i++)
+    mpPassProfiler = std::make_unique<PassProfiler>(getDevice());
+    mpGraph = std::make_unique<TechniqueGraph>(getDevice());
+    for (const auto& pTechnique : mTechniques)
     {
-        mpRTs[i] = getDevice()->createTexture2D(
-            width, height, kGBufferChannels[i].format, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
-        );
-        mpFbo->attachColorTarget(mpRTs[i], i);
+        pTechnique->onLoad(getDevice(), *mpGraph);
+        enableJitter |= pTechnique->needsCameraJitter();
     }
-    mpDepthRT = getDevice()->createTexture2D(
-        width, height, ResourceFormat::D32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::DepthStencil
-    );
-    mpFbo->attachDepthStencilTarget(mpDepthRT);
+    // Import every channel up front, so the graph compiles and reports its demand before anything is allocated.
+    for (const auto& channel : getGBufferChannels(mGBufferLayout))
+        mpGraph->importTexture(channel.name, nullptr);
+    mpGraph->importTexture("depth", nullptr);
+    mStoredChannels = getDemandedChannels();
+
+    resizeRenderTargets(getRenderDim());
     Sampler::Desc samplerDesc;
     samplerDesc.setComparisonFunc(ComparisonFunc::Never);
     gSampler = getDevice()->createSampler(samplerDesc);
@@ -56,17 +77,190 @@ void GBuffer::onLoad(RenderContext* pRenderContext)
 
 void GBuffer::onShutdown() {}
 
+void GBuffer::addTechnique(std::shared_ptr<GBufferTechnique> pTechnique)
+{
+    FALCOR_ASSERT(!mpGraph);
+    mTechniques.push_back(std::move(pTechnique));
+}
+
+const ChannelList& GBuffer::getGBufferChannels(GBufferLayout layout)
+{
+    return layout == GBufferLayout::Compact ? kCompactGBufferChannels : kGBufferChannels;
+}
+
+uint32_t GBuffer::getGBufferBytesPerPixel(GBufferLayout layout)
+{
+    uint32_t bytes = getFormatBytesPerBlock(ResourceFormat::D32Float);
+    for (const auto& channel : getGBufferChannels(layout))
+    {
+        if (channel.format != ResourceFormat::Unknown)
+            bytes += getFormatBytesPerBlock(channel.format);
+    }
+    return bytes;
+}
+
+bool GBuffer::isGBufferChannelStored(uint32_t index) const
+{
+    return (mStoredChannels >> index) & 1;
+}
+
+uint32_t GBuffer::getDemandedChannels()
+{
+    const bool showChannel[] = {true, showPosW || mWritePosW, showNormalW, showTangentW, showFaceNormalW, showMotionVector};
+    const ChannelList& channels = getGBufferChannels(mGBufferLayout);
+    mpGraph->update();
+    const auto& reads = mpGraph->getReadImports();
+
+    uint32_t demanded = 0;
+    for (uint32_t i = 0; i < channels.size(); i++)
+    {
+        // Color is always stored, it is what gets presented when no technique runs.
+        bool read = i == 0 || showChannel[i] || std::find(reads.begin(), reads.end(), channels[i].name) != reads.end();
+        if (read && channels[i].format != ResourceFormat::Unknown)
+            demanded |= 1u << i;
+    }
+    return demanded;
+}
+
+void GBuffer::updateGBufferTargets(bool force)
+{
+    uint32_t demanded = getDemandedChannels();
+    if (!force && demanded == mStoredChannels)
+        return;
+    mStoredChannels = demanded;
+    createGBufferTargets(mpFbo->getWidth(), mpFbo->getHeight());
+    if (mpRasterPass)
+        updatePassDefines(mpRasterPass.get(), getRasterDefines());
+}
+
+void GBuffer::createGBufferTargets(uint32_t width, uint32_t height)
+{
+    const ChannelList& channels = getGBufferChannels(mGBufferLayout);
+    for (uint32_t i = 0; i < channels.size(); i++)
+    {
+        // Channels that are not stored leave their render target slot empty.
+        mpRTs[i] = !isGBufferChannelStored(i)
+                       ? nullptr
+                       : getDevice()->createTexture2D(
+                             width, height, channels[i].format, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
+                         );
+        mpFbo->attachColorTarget(mpRTs[i], i);
+        mpGraph->importTexture(channels[i].name, mpRTs[i]);
+    }
+    mpDepthRT = getDevice()->createTexture2D(
+        width, height, ResourceFormat::D32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::DepthStencil
+    );
+    mpFbo->attachDepthStencilTarget(mpDepthRT);
+    mpGraph->importTexture("depth", mpDepthRT);
+}
+
+void GBuffer::setGBufferLayout(GBufferLayout layout)
+{
+    if (layout == mGBufferLayout)
+        return;
+    mGBufferLayout = layout;
+    updateGBufferTargets(true);
+}
+
+DefineList GBuffer::getGBufferDefines() const
+{
+    return {
+        {"GBUFFER_COMPACT", mGBufferLayout == GBufferLayout::Compact ? "1" : "0"},
+        {"GBUFFER_WRITE_POSW", isGBufferChannelStored(1) ? "1" : "0"},
+    };
+}
+
+DefineList GBuffer::getRasterDefines() const
+{
+    DefineList defines = getGBufferDefines();
+    const ChannelList& channels = getGBufferChannels(mGBufferLayout);
+    // GBUFFER_WRITE_<CHANNEL> for every channel but color, which is always written.
+    for (uint32_t i = 1; i < channels.size(); i++)
+    {
+        std::string name = channels[i].name;
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+        defines.add("GBUFFER_WRITE_" + name, isGBufferChannelStored(i) ? "1" : "0");
+    }
+    return defines;
+}
+
+bool GBuffer::updateGBufferDefines(BaseGraphicsPass* pPass) const
+{
+    return updatePassDefines(pPass, getGBufferDefines());
+}
+
+bool GBuffer::updateProgramDefines(Program* pProgram, const DefineList& passDefines)
+{
+    const DefineList& defines = pProgram->getDefines();
+    bool changed = false;
+    for (const auto& [name, value] : passDefines)
+    {
+        auto it = defines.find(name);
+        changed |= it == defines.end() || it->second != value;
+    }
+    if (changed)
+        pProgram->addDefines(passDefines);
+    return changed;
+}
+
+bool GBuffer::updatePassDefines(BaseGraphicsPass* pPass, const DefineList& passDefines)
+{
+    if (!updateProgramDefines(pPass->getProgram().get(), passDefines))
+        return false;
+    pPass->setVars(nullptr);
+    return true;
+}
+
+bool GBuffer::updatePassDefines(ComputePass* pPass, const DefineList& passDefines)
+{
+    if (!updateProgramDefines(pPass->getProgram().get(), passDefines))
+        return false;
+    pPass->setVars(nullptr);
+    return true;
+}
+
 void GBuffer::onResize(uint32_t width, uint32_t height)
 {
-    //
+    if (width == 0 || height == 0)
+        return; // Minimized window
+    screenWidth = width;
+    screenHeight = height;
+    if (mpCamera)
+        mpCamera->setAspectRatio((float)width / (float)height);
+    if (mpFbo && any(getRenderDim() != uint2(mpFbo->getWidth(), mpFbo->getHeight())))
+        resizeRenderTargets(getRenderDim());
+}
+
+uint2 GBuffer::getRenderDim() const
+{
+    return uint2(
+        std::max(1u, (uint32_t)std::lround(screenWidth * mRenderScale)), std::max(1u, (uint32_t)std::lround(screenHeight * mRenderScale))
+    );
+}
+
+void GBuffer::setRenderScale(float scale)
+{
+    mRenderScale = std::clamp(scale, 0.5f, 1.0f);
+    if (mpFbo && any(getRenderDim() != uint2(mpFbo->getWidth(), mpFbo->getHeight())))
+        resizeRenderTargets(getRenderDim());
+}
+
+void GBuffer::resizeRenderTargets(uint2 renderDim)
+{
+    createGBufferTargets(renderDim.x, renderDim.y);
+    for (const auto& pTechnique : mTechniques)
+        pTechnique->onResize(renderDim);
 }
 
 void GBuffer::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
 {
-    pRenderContext->clearFbo(pTargetFbo.get(), kClearColor, 1.0f, 0, FboAttachmentType::All);
+    mpPassProfiler->beginFrame();
+    // Techniques toggled since the last frame may read different channels.
+    updateGBufferTargets(false);
+    pRenderContext->clearFbo(mpFbo.get(), kClearColor, 1.0f, 0, FboAttachmentType::All);
     if (mpScene)
     {
-        updateFrameDim(uint2(pTargetFbo->getWidth(), pTargetFbo->getHeight()));
+        updateFrameDim(uint2(mpFbo->getWidth(), mpFbo->getHeight()));
         Scene::UpdateFlags updates = mpScene->update(pRenderContext, getGlobalClock().getTime());
         if (is_set(updates, Scene::UpdateFlags::GeometryChanged))
             FALCOR_THROW("This sample does not support scene geometry changes.");
@@ -74,13 +268,23 @@ void GBuffer::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTarg
             FALCOR_THROW("This sample does not support scene changes that require shader recompilation.");
 
         FALCOR_ASSERT(mpScene);
-        FALCOR_PROFILE(pRenderContext, "renderRaster");
+        PASS_PROFILE(mpPassProfiler.get(), pRenderContext, "renderRaster");
 
         mpRasterPass->getRootVar()["PerFrameCB"]["gFrameDim"] = mFrameDim;
 
-        mpRasterPass->getState()->setFbo(pTargetFbo);
+        mpRasterPass->getState()->setFbo(mpFbo);
         mpScene->rasterize(pRenderContext, mpRasterPass->getState().get(), mpRasterPass->getVars().get());
     }
+
+    TechniqueGraph::FrameContext ctx;
+    ctx.pRenderContext = pRenderContext;
+    ctx.pCamera = mpCamera.get();
+    ctx.pSampler = gSampler;
+    ctx.pProfiler = mpPassProfiler.get();
+    ctx.gbufferDefines = getGBufferDefines();
+    ctx.renderDim = uint2(mpFbo->getWidth(), mpFbo->getHeight());
+    ctx.frameIndex = mFrameCount++;
+    mpGraph->execute(ctx, pTargetFbo);
 }
 
 void GBuffer::onGuiRender(Gui* pGui)
@@ -92,17 +296,53 @@ void GBuffer::onGuiRender(Gui* pGui)
     const uint2 imageSize = {screenWidth / 4, screenHeight / 4};
 #define GUI_CB(name, idx)                            \
     w.checkbox(#name, show##name);                   \
-    if (show##name)                                    \
+    if (show##name && mpRTs[idx])                    \
     {                                                \
         Gui::Window d(pGui, #name, windowSize);      \
         d.image(#name, mpRTs[idx].get(), imageSize); \
     }
     
+    float renderScale = mRenderScale;
+    if (w.slider("Render Scale", renderScale, 0.5f, 1.0f))
+        setRenderScale(renderScale);
+    w.text(fmt::format("Render {}x{}, output {}x{}", mpFbo->getWidth(), mpFbo->getHeight(), screenWidth, screenHeight));
+
+    uint32_t layout = (uint32_t)mGBufferLayout;
+    if (w.dropdown("G-Buffer Layout", kGBufferLayoutDropdown, layout))
+        setGBufferLayout((GBufferLayout)layout);
+    uint32_t bytesPerPixel = getFormatBytesPerBlock(mpDepthRT->getFormat());
+    for (const auto& pRT : mpRTs)
+        bytesPerPixel += pRT ? getFormatBytesPerBlock(pRT->getFormat()) : 0;
+    uint32_t fullBytesPerPixel = getGBufferBytesPerPixel(GBufferLayout::Full);
+    double pixelCount = (double)mpFbo->getWidth() * mpFbo->getHeight();
+    w.text(fmt::format(
+        "{} B/px, {:.1f} MB ({:.0f}% of full layout with posW)",
+        bytesPerPixel,
+        bytesPerPixel * pixelCount / (1024.0 * 1024.0),
+        100.0 * bytesPerPixel / fullBytesPerPixel
+    ));
+    if (mGBufferLayout == GBufferLayout::Full)
+        w.checkbox("Write posW", mWritePosW);
+
     GUI_CB(PosW, 1)
     GUI_CB(NormalW, 2)
     GUI_CB(TangentW, 3)
     GUI_CB(FaceNormalW, 4)
     GUI_CB(MotionVector, 5)
+#undef GUI_CB
+
+    if (auto g = w.group("Technique Graph"))
+        mpGraph->renderUI(g);
+
+    w.checkbox("Pass Timings", showPassTimings);
+    if (showPassTimings)
+    {
+        Gui::Window t(pGui, "Pass Timings", {620, 300});
+        mpPassProfiler->renderUI(t);
+    }
+
+    for (const auto& pTechnique : mTechniques)
+        pTechnique->onGuiRender(pGui);
 }
 
 bool GBuffer::onKeyEvent(const KeyboardEvent& keyEvent)
@@ -146,6 +386,7 @@ void GBuffer::loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo
     rasterProgDesc.addTypeConformances(typeConformances);
 
     mpRasterPass = RasterPass::create(getDevice(), rasterProgDesc, defines);
+    updatePassDefines(mpRasterPass.get(), getRasterDefines());
 }
 
 ref<CPUSampleGenerator> GBuffer::createSamplePattern(SamplePattern type, uint32_t sampleCount)
@@ -3,9 +3,13 @@
 #include "Core/SampleApp.h"
 #include "Core/Pass/RasterPass.h"
 #include "Core/Pass/FullScreenPass.h"
+#include "Core/Pass/ComputePass.h"
 #include "Utils/SampleGenerators/DxSamplePattern.h"
 #include "Utils/SampleGenerators/HaltonSamplePattern.h"
 #include "Utils/SampleGenerators/StratifiedSamplePattern.h"
+#include "PassProfiler.h"
+#include "GBufferTechnique.h"
+#include "TechniqueGraph.h"
 #include <random>
 
 using namespace Falcor;
@@ -35,6 +39,11 @@ FALCOR_ENUM_INFO(
         {SamplePattern::Stratified, "Stratified"},
     }
 );
+enum class GBufferLayout : uint32_t
+{
+    Full,    ///< RGBA32Float for all channels, posW stored explicitly.
+    Compact, ///< Half-precision color/tangent, octahedral RG16Snorm normals, RG16Float motion, posW reconstructed from depth.
+};
 using ChannelList = std::vector<ChannelDesc>;
 class GBuffer : public SampleApp
 {
@@ -52,17 +61,59 @@ public:
     virtual void onHotReload(HotReloadFlags reloaded) override;
     virtual void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo);
 
+    /// Layout used by newly created samples, settable from the command line.
+    static GBufferLayout sDefaultLayout;
+    /// Render scale used by newly created samples, settable from the command line.
+    static float sDefaultRenderScale;
+
+    /// Sets the given defines on the pass program and recreates its vars if any of them changed. Returns true in that case.
+    static bool updatePassDefines(BaseGraphicsPass* pPass, const DefineList& passDefines);
+    static bool updatePassDefines(ComputePass* pPass, const DefineList& passDefines);
+
 protected:
+    /// Adds a technique to the frame, after the ones added before. Call before GBuffer::onLoad().
+    void addTechnique(std::shared_ptr<GBufferTechnique> pTechnique);
     ref<CPUSampleGenerator> createSamplePattern(SamplePattern type, uint32_t sampleCount);
     void updateSamplePattern();
     void updateFrameDim(const uint2 frameDim);
+    /// Internal render resolution, the output resolution scaled by mRenderScale.
+    uint2 getRenderDim() const;
+    void setRenderScale(float scale);
+    /** Called whenever the internal render resolution changes, including the initial allocation in onLoad().
+        Derived samples override this to reallocate their own resolution dependent targets and must call the base version.
+    */
+    virtual void resizeRenderTargets(uint2 renderDim);
     std::mt19937 rng;
     std::uniform_int_distribution<uint32_t> distInt = std::uniform_int_distribution<uint32_t>(0, 100);
     std::uniform_real<float> distReal = std::uniform_real<float>(0.0f, 1.0f);
     uint32_t getRandomInt() { return distInt(rng); }
     float getRandomFloat() { return distReal(rng); }
     uint32_t screenWidth, screenHeight;
+    float mRenderScale = sDefaultRenderScale;
     static const ChannelList kGBufferChannels;
+    static const ChannelList kCompactGBufferChannels;
+    static const ChannelList& getGBufferChannels(GBufferLayout layout);
+    static uint32_t getGBufferBytesPerPixel(GBufferLayout layout);
+    void createGBufferTargets(uint32_t width, uint32_t height);
+    void setGBufferLayout(GBufferLayout layout);
+    /// Passes that read the G-buffer must be compiled with the defines of the current layout (see GBufferHelpers.slangh).
+    /// Returns true if the defines changed, in which case the pass vars were recreated and need to be bound again.
+    bool updateGBufferDefines(BaseGraphicsPass* pPass) const;
+    /// Adds the defines to the program. Returns true if any of them changed, the caller then recreates the vars.
+    static bool updateProgramDefines(Program* pProgram, const DefineList& passDefines);
+    DefineList getGBufferDefines() const;
+    /// G-buffer defines plus a GBUFFER_WRITE_<CHANNEL> define per channel, for GBuffer.3d.slang.
+    DefineList getRasterDefines() const;
+    bool isGBufferChannelStored(uint32_t index) const;
+    /// Mask of the channels read by the live graph nodes or shown by the debug views. Color is always included.
+    uint32_t getDemandedChannels();
+    /// Reallocates the G-buffer targets and recompiles the raster pass if the demanded channels changed, or if `force` is set.
+    void updateGBufferTargets(bool force);
+    GBufferLayout mGBufferLayout = sDefaultLayout;
+    /// Store posW in the full layout. Nothing reads it anymore, it is only kept for the debug view.
+    bool mWritePosW = false;
+    /// Mask of the channels GBuffer.3d.slang writes. Channels outside of it have no render target.
+    uint32_t mStoredChannels = 1;
     ref<Texture> mpRTs[6];
     ref<Texture> mpDepthRT;
     ref<Scene> mpScene;
@@ -83,8 +134,15 @@ protected:
 
     ref<Fbo> mpFbo;
     ref<Sampler> gSampler;
+    /// Per-pass CPU/GPU timings of the G-buffer and every technique built on top of it.
+    std::unique_ptr<PassProfiler> mpPassProfiler;
+    bool showPassTimings = false;
     ref<RasterPass> mpRasterPass;
 
+    /// Techniques run on the G-buffer each frame, through mpGraph. The G-buffer color is presented if there are none.
+    std::vector<std::shared_ptr<GBufferTechnique>> mTechniques;
+    std::unique_ptr<TechniqueGraph> mpGraph;
+
     uint32_t mFrameCount = 0;
     /// Current frame dimension in pixels. Note this may be different from the window size.
     uint2 mFrameDim = {};
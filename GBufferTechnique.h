@@ -0,0 +1,25 @@
+#pragma once
+#include "Falcor.h"
+#include "TechniqueGraph.h"
+
+using namespace Falcor;
+
+/** Screen-space technique on top of the G-buffer, e.g. SSAO or TAA.
+    A technique never touches the G-buffer targets itself. It adds nodes to the TechniqueGraph of the sample hosting
+    it, which read the G-buffer channels and the outputs of other techniques by name. This lets a sample stack any
+    number of techniques, which run in the order they were added.
+ */
+class GBufferTechnique
+{
+public:
+    virtual ~GBufferTechnique() = default;
+
+    virtual std::string getName() const = 0;
+    /// Creates the passes and adds the nodes to the graph. Called once, before the render targets are allocated.
+    virtual void onLoad(const ref<Device>& pDevice, TechniqueGraph& graph) = 0;
+    /// Called whenever the internal render resolution changes, including the initial allocation.
+    virtual void onResize(uint2 renderDim) {}
+    virtual void onGuiRender(Gui* pGui) {}
+    /// Techniques resolving samples over time need the camera to be jittered.
+    virtual bool needsCameraJitter() const { return false; }
+};
@@ -0,0 +1,38 @@
+#include "HiZPyramid.h"
+
+HiZPyramid::HiZPyramid(const ref<Device>& pDevice) : mpDevice(pDevice)
+{
+    mpPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/HiZ.cs.slang", "main");
+}
+
+void HiZPyramid::build(RenderContext* pRenderContext, const ref<Texture>& pDepth)
+{
+    FALCOR_PROFILE(pRenderContext, "HiZ");
+
+    uint32_t width = pDepth->getWidth(), height = pDepth->getHeight();
+    if (!mpTexture || mpTexture->getWidth() != width || mpTexture->getHeight() != height)
+    {
+        mpTexture = mpDevice->createTexture2D(
+            width,
+            height,
+            ResourceFormat::R32Float,
+            1,
+            Texture::kMaxPossible,
+            nullptr,
+            ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+        );
+    }
+
+    ShaderVar var = mpPass->getRootVar();
+    for (uint32_t mip = 0; mip < mpTexture->getMipCount(); mip++)
+    {
+        uint2 srcSize = mip == 0 ? uint2(width, height) : uint2(mpTexture->getWidth(mip - 1), mpTexture->getHeight(mip - 1));
+        uint2 dstSize = uint2(mpTexture->getWidth(mip), mpTexture->getHeight(mip));
+        var["PerFrameCB"]["gSrcSize"] = srcSize;
+        var["PerFrameCB"]["gDstSize"] = dstSize;
+        var["PerFrameCB"]["gCopy"] = mip == 0 ? 1u : 0u;
+        var["gSrc"].setSrv(mip == 0 ? pDepth->getSRV() : mpTexture->getSRV(mip - 1, 1, 0, 1));
+        var["gDst"].setUav(mpTexture->getUAV(mip, 0, 1));
+        mpPass->execute(pRenderContext, uint3(dstSize, 1));
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/Pass/ComputePass.h"
+
+using namespace Falcor;
+
+/** Hierarchical depth buffer for occlusion culling: a full mip chain of an R32Float copy of a depth buffer, each
+    texel of a level holding the farthest depth of the texels it covers. Built with one compute dispatch per level.
+ */
+class HiZPyramid
+{
+public:
+    HiZPyramid(const ref<Device>& pDevice);
+
+    /// Rebuilds the pyramid from `pDepth`, reallocating it when the size changes.
+    void build(RenderContext* pRenderContext, const ref<Texture>& pDepth);
+
+    const ref<Texture>& getTexture() const { return mpTexture; }
+    bool isValid() const { return mpTexture != nullptr; }
+
+private:
+    ref<Device> mpDevice;
+    ref<ComputePass> mpPass;
+    ref<Texture> mpTexture;
+};
@@ -0,0 +1,78 @@
+#include "InstanceStore.h"
+#include "JobSystem.h"
+
+namespace
+{
+// Smallest range of instances worth a thread.
+const size_t kMinRange = 16384;
+
+uint32_t hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+float hashToFloat(uint32_t x)
+{
+    return (hash(x) >> 8) * (1.0f / 16777216.0f);
+}
+} // namespace
+
+void InstanceStore::resize(uint32_t count, float extent)
+{
+    uint32_t side = std::max(1u, (uint32_t)std::ceil(std::cbrt((double)count)));
+    float spacing = extent / side;
+    mExtent = extent;
+
+    // The grid spacing depends on the count, so all positions are recomputed. The rest is per instance.
+    uint32_t oldCount = getCount();
+    mPositionX.resize(count);
+    mPositionY.resize(count);
+    mPositionZ.resize(count);
+    mScale.resize(count);
+    mPhase.resize(count);
+    mAngularSpeed.resize(count);
+    mMaterialId.resize(count);
+    mInstanceData.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t x = i % side, y = (i / side) % side, z = i / (side * side);
+        mPositionX[i] = (x + 0.5f) * spacing - 0.5f * extent;
+        mPositionY[i] = (y + 0.5f) * spacing - 0.5f * extent;
+        mPositionZ[i] = (z + 0.5f) * spacing - 0.5f * extent;
+        mScale[i] = 0.6f * spacing;
+        if (i >= oldCount)
+        {
+            mPhase[i] = hashToFloat(i * 3) * 6.2831853f;
+            mAngularSpeed[i] = hashToFloat(i * 3 + 1) * 2.0f - 1.0f;
+            mMaterialId[i] = hash(i * 3 + 2) % kMaterialCount;
+        }
+    }
+}
+
+void InstanceStore::update(float time, uint32_t threadCount)
+{
+    JobSystem::get().parallelFor(
+        getCount(),
+        threadCount,
+        kMinRange,
+        1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                float angle = mPhase[i] + mAngularSpeed[i] * time;
+                float c = std::cos(angle) * mScale[i], s = std::sin(angle) * mScale[i];
+                InstanceData& data = mInstanceData[i];
+                data.transform[0] = float4(c, 0.f, s, mPositionX[i]);
+                data.transform[1] = float4(0.f, mScale[i], 0.f, mPositionY[i]);
+                data.transform[2] = float4(-s, 0.f, c, mPositionZ[i]);
+                data.materialId = mMaterialId[i];
+            }
+        }
+    );
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** CPU side of DrawInstancing: the instance attributes in structure-of-arrays form, from which the GPU records
+    are rebuilt every frame on the JobSystem workers. Instances are laid out on a grid that fills a cube of the given
+    extent whatever their count, and spin around their Y axis at their own speed.
+ */
+class InstanceStore
+{
+public:
+    /// GPU record of an instance, matches InstanceData in InstanceData.slangh.
+    struct InstanceData
+    {
+        float4 transform[3]; ///< Rows of the 3x4 object to world matrix.
+        uint32_t materialId;
+        uint32_t padding[3];
+    };
+    static_assert(sizeof(InstanceData) == 64);
+
+    static const uint32_t kMaterialCount = 4;
+
+    /// `extent` is the edge length of the cube centered at the origin the grid fills. Keeps the attributes of the
+    /// first instances, so growing the count does not reshuffle the materials.
+    void resize(uint32_t count, float extent);
+    uint32_t getCount() const { return (uint32_t)mPhase.size(); }
+    float getExtent() const { return mExtent; }
+
+    /// Rebuilds the GPU records for `time`. `threadCount` includes the caller's thread, 0 uses all JobSystem workers.
+    void update(float time, uint32_t threadCount = 0);
+    const std::vector<InstanceData>& getInstanceData() const { return mInstanceData; }
+
+private:
+    float mExtent = 0.f;
+    std::vector<float> mPositionX, mPositionY, mPositionZ;
+    std::vector<float> mScale;
+    std::vector<float> mPhase;
+    std::vector<float> mAngularSpeed;
+    std::vector<uint32_t> mMaterialId;
+    std::vector<InstanceData> mInstanceData;
+};
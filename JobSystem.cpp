@@ -0,0 +1,145 @@
+#include "JobSystem.h"
+#include "Utils/Math/FalcorMath.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace
+{
+struct BatchStats
+{
+    double median;
+    double p99;
+};
+
+/// The CPU side of a raster pass: the matrices it binds.
+float4x4 preparePass(const float4x4& viewProj, const float4x4& world)
+{
+    return mul(viewProj, transpose(inverse(world)));
+}
+} // namespace
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem sJobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return sJobSystem;
+}
+
+void JobSystem::runBenchmark(uint32_t batchCount)
+{
+    const uint32_t kJobsPerBatch = 2;
+
+    JobSystem& jobSystem = get();
+    float4x4 viewProj = math::perspective(math::radians(60.f), 16.f / 9.f, 0.25f, 100.f);
+    float4x4 results[kJobsPerBatch];
+
+    auto measure = [&](bool parallel)
+    {
+        std::vector<double> times(batchCount);
+        for (uint32_t batch = 0; batch < batchCount; batch++)
+        {
+            float4x4 world = math::rotate(float4x4::identity(), math::radians(float(batch)), float3(0, 1, 0));
+            auto start = CpuTimer::getCurrentTimePoint();
+            if (parallel)
+            {
+                std::future<void> jobs[kJobsPerBatch];
+                for (uint32_t i = 0; i < kJobsPerBatch; i++)
+                    jobs[i] = jobSystem.submit([&, i]() { results[i] = preparePass(viewProj, world); });
+                for (auto& job : jobs)
+                    jobSystem.wait(job);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < kJobsPerBatch; i++)
+                    results[i] = preparePass(viewProj, world);
+            }
+            times[batch] = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        }
+        std::sort(times.begin(), times.end());
+        return BatchStats{times[batchCount / 2], times[std::min<size_t>(batchCount - 1, batchCount * 99 / 100)]};
+    };
+
+    BatchStats inlineStats = measure(false);
+    BatchStats parallelStats = measure(true);
+    logInfo(
+        "Job benchmark, {} batches of {} pass preparations: inline {:.4f} ms median, {:.4f} ms p99; on {} workers {:.4f} ms "
+        "median, {:.4f} ms p99.",
+        batchCount,
+        kJobsPerBatch,
+        inlineStats.median,
+        inlineStats.p99,
+        jobSystem.getThreadCount(),
+        parallelStats.median,
+        parallelStats.p99
+    );
+}
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+    for (uint32_t i = 0; i < std::max(1u, threadCount); i++)
+        mThreads.emplace_back([this]() { workerLoop(); });
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    for (auto& thread : mThreads)
+        thread.join();
+}
+
+std::future<void> JobSystem::submit(std::function<void()> job)
+{
+    std::packaged_task<void()> task(std::move(job));
+    std::future<void> future = task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back(std::move(task));
+    }
+    mCondition.notify_one();
+    return future;
+}
+
+void JobSystem::wait(std::future<void>& future)
+{
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        std::packaged_task<void()> task = popJob();
+        if (!task.valid())
+        {
+            // The job is running on a worker already.
+            future.wait();
+            break;
+        }
+        task();
+    }
+    future.get();
+}
+
+std::packaged_task<void()> JobSystem::popJob()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mQueue.empty())
+        return {};
+    std::packaged_task<void()> task = std::move(mQueue.front());
+    mQueue.pop_front();
+    return task;
+}
+
+void JobSystem::workerLoop()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+            if (mStop && mQueue.empty())
+                return;
+            task = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "Falcor.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Falcor;
+
+/** Fixed pool of worker threads for the short CPU jobs of a frame, so that no thread is created per frame.
+    Jobs run in submission order as workers become free. Exceptions thrown by a job are rethrown by its future.
+    parallelFor() splits loops over the pool, it is what the data-parallel CPU code of the samples runs on.
+ */
+class JobSystem
+{
+public:
+    /// Process-wide pool with one worker per hardware thread but the main thread's.
+    static JobSystem& get();
+
+    explicit JobSystem(uint32_t threadCount);
+    ~JobSystem();
+
+    std::future<void> submit(std::function<void()> job);
+    uint32_t getThreadCount() const { return (uint32_t)mThreads.size(); }
+
+    /** Times `batchCount` batches of two jobs the size of a raster pass's CPU preparation (a 4x4 inverse transpose and
+        product each) run inline, then submitted to the pool and waited for, and logs the CPU time per batch.
+        Work smaller than the fork/join cost it measures is not worth a job.
+     */
+    static void runBenchmark(uint32_t batchCount);
+
+    /// Waits for a job of this pool, running queued jobs on the calling thread meanwhile, so that jobs may wait for
+    /// other jobs without starving the pool. Rethrows the exception of the job.
+    void wait(std::future<void>& future);
+
+    /** Calls `func(begin, end)` for consecutive ranges of [0, count) and returns once all ranges are done.
+        The calling thread takes the first range and the workers the others. `rangeCount` limits the number of ranges,
+        0 uses every worker. Ranges hold at least `minRange` items and start at multiples of `alignment`, e.g. 4 so
+        that SIMD loops only have a tail in the last range.
+     */
+    template<typename Func>
+    void parallelFor(size_t count, uint32_t rangeCount, size_t minRange, size_t alignment, const Func& func)
+    {
+        size_t maxRanges = std::min<size_t>(rangeCount ? rangeCount : getThreadCount() + 1, getThreadCount() + 1);
+        maxRanges = std::min(maxRanges, (count + minRange - 1) / minRange);
+        if (maxRanges <= 1)
+        {
+            func(size_t(0), count);
+            return;
+        }
+
+        size_t rangeSize = ((count + maxRanges - 1) / maxRanges + alignment - 1) / alignment * alignment;
+        std::vector<std::future<void>> ranges;
+        for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+            ranges.push_back(submit([&func, begin, end = std::min(count, begin + rangeSize)]() { func(begin, end); }));
+        // The jobs reference `func`, so they are waited for even if the first range throws.
+        std::exception_ptr pException;
+        try
+        {
+            func(size_t(0), std::min(count, rangeSize));
+        }
+        catch (...)
+        {
+            pException = std::current_exception();
+        }
+        for (auto& range : ranges)
+        {
+            try
+            {
+                wait(range);
+            }
+            catch (...)
+            {
+                if (!pException)
+                    pException = std::current_exception();
+            }
+        }
+        if (pException)
+            std::rethrow_exception(pException);
+    }
+
+private:
+    void workerLoop();
+    /// Pops the next queued job, an invalid task if the queue is empty.
+    std::packaged_task<void()> popJob();
+
+    std::vector<std::thread> mThreads;
+    std::deque<std::packaged_task<void()>> mQueue;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop = false;
+};
@@ -0,0 +1,347 @@
+#include "MeshCache.h"
+#include "TangentGenerator.h"
+
+namespace
+{
+bool isBinaryUpToDate(const std::filesystem::path& binaryPath, const std::filesystem::path& sourcePath)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(binaryPath, ec))
+        return false;
+    if (std::filesystem::last_write_time(binaryPath, ec) < std::filesystem::last_write_time(sourcePath, ec))
+    {
+        logWarning("Ignoring '{}', it is older than its source.", binaryPath.string());
+        return false;
+    }
+    if (!BinaryMesh::isCurrentVersion(binaryPath))
+    {
+        logWarning("Ignoring '{}', it was written by another version.", binaryPath.string());
+        return false;
+    }
+    return true;
+}
+
+/// Octahedral mapping as ndir_to_oct_snorm in Utils.Math.MathHelpers, to snorm16.
+void encodeOctSnorm16(float3 n, int16_t result[2])
+{
+    float2 p = float2(n.x, n.y) / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+    if (n.z < 0.f)
+    {
+        p = float2(
+            (1.f - std::abs(p.y)) * (p.x >= 0.f ? 1.f : -1.f),
+            (1.f - std::abs(p.x)) * (p.y >= 0.f ? 1.f : -1.f)
+        );
+    }
+    for (int i = 0; i < 2; i++)
+        result[i] = (int16_t)std::lround(std::clamp(p[i], -1.f, 1.f) * 32767.f);
+}
+
+/// Round to nearest even. Denormals flush to zero and overflows become infinity, neither matters for UVs.
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0)
+        return (uint16_t)sign;
+    if (exponent >= 31)
+        return (uint16_t)(sign | 0x7c00);
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;
+    return (uint16_t)half;
+}
+} // namespace
+
+const std::string MeshCache::kCube = "<cube>";
+const std::string MeshCache::kSphere = "<sphere>";
+
+std::shared_ptr<MeshCache> MeshCache::get(const ref<Device>& pDevice)
+{
+    // Weak references only, the samples own the caches.
+    static std::map<Device*, std::weak_ptr<MeshCache>> sCaches;
+    std::shared_ptr<MeshCache> pCache = sCaches[pDevice.get()].lock();
+    if (!pCache)
+    {
+        pCache = std::make_shared<MeshCache>(pDevice);
+        sCaches[pDevice.get()] = pCache;
+    }
+    return pCache;
+}
+
+const MeshCache::Mesh& MeshCache::getMesh(const std::string& source, MeshVertexLayout layout, bool smoothNormals)
+{
+    Key key{source, layout, smoothNormals};
+    auto it = mMeshes.find(key);
+    if (it != mMeshes.end())
+        return it->second;
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    MeshData data;
+    std::filesystem::path sourcePath(source);
+    std::filesystem::path binaryPath = sourcePath.extension() == ".fmesh" ? sourcePath : getBinaryPath(source, layout, smoothNormals);
+    if (binaryPath == sourcePath || isBinaryUpToDate(binaryPath, sourcePath))
+        map(binaryPath, layout, data);
+    else
+        parse(source, layout, smoothNormals, data);
+    double loadMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    const Mesh& mesh = mMeshes[key] = upload(data, layout);
+    logInfo(
+        "Uploaded mesh '{}': {} vertices of {} bytes, {} indices, {} in {:.1f} ms, upload {:.1f} ms.",
+        source,
+        mesh.vertexCount,
+        getVertexStride(layout),
+        mesh.indexCount,
+        data.pBinary ? "mapped" : "parsed",
+        loadMs,
+        CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) - loadMs
+    );
+    return mesh;
+}
+
+std::filesystem::path MeshCache::convert(const std::string& source, MeshVertexLayout layout, bool smoothNormals)
+{
+    MeshData data;
+    parse(source, layout, smoothNormals, data);
+    std::filesystem::path path = getBinaryPath(source, layout, smoothNormals);
+    BinaryMesh::write(
+        path,
+        (uint32_t)layout,
+        data.pVertices,
+        getVertexStride(layout),
+        data.vertexCount,
+        data.pIndices,
+        data.indexStride,
+        data.indexCount,
+        data.positionScale,
+        data.positionOffset
+    );
+    logInfo("Converted mesh '{}' to '{}'.", source, path.string());
+    return path;
+}
+
+std::filesystem::path MeshCache::getBinaryPath(const std::string& source, MeshVertexLayout layout, bool smoothNormals)
+{
+    std::string suffix = layout == MeshVertexLayout::TangentSpace            ? ".tangent"
+                         : layout == MeshVertexLayout::TangentSpaceCompressed ? ".compressed"
+                                                                              : ".standard";
+    if (smoothNormals)
+        suffix += ".smooth";
+    return source + suffix + ".fmesh";
+}
+
+uint32_t MeshCache::getVertexStride(MeshVertexLayout layout)
+{
+    switch (layout)
+    {
+    case MeshVertexLayout::TangentSpace:
+        return sizeof(TangentVertex);
+    case MeshVertexLayout::TangentSpaceCompressed:
+        return sizeof(CompressedTangentVertex);
+    default:
+        return sizeof(PackedStaticVertexData);
+    }
+}
+
+void MeshCache::parse(const std::string& source, MeshVertexLayout layout, bool smoothNormals, MeshData& data)
+{
+    ref<TriangleMesh> pMesh;
+    if (source == kCube)
+        pMesh = TriangleMesh::createCube();
+    else if (source == kSphere)
+        pMesh = TriangleMesh::createSphere();
+    else
+        pMesh = TriangleMesh::createFromFile(source, smoothNormals);
+    if (!pMesh)
+        FALCOR_THROW("Failed to load mesh '{}'.", source);
+
+    // Reordered before the tangents, which do not depend on the order.
+    data.vertices = pMesh->getVertices();
+    data.indices = pMesh->getIndices();
+    auto start = CpuTimer::getCurrentTimePoint();
+    auto [before, after] = MeshOptimizer::optimize(data.vertices, data.indices);
+
+    const TriangleMesh::VertexList& vertices = data.vertices;
+    const TriangleMesh::IndexList& indices = data.indices;
+    data.vertexCount = (uint32_t)vertices.size();
+    data.indexCount = (uint32_t)indices.size();
+    if (data.vertexCount < 0x10000)
+    {
+        data.indices16.assign(indices.begin(), indices.end());
+        data.pIndices = data.indices16.data();
+        data.indexStride = sizeof(uint16_t);
+    }
+    else
+    {
+        data.pIndices = indices.data();
+        data.indexStride = sizeof(uint32_t);
+    }
+    logInfo(
+        "Optimized mesh '{}' in {:.1f} ms: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {}-bit indices.",
+        source,
+        CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()),
+        before.acmr,
+        after.acmr,
+        before.atvr,
+        after.atvr,
+        data.indexStride * 8
+    );
+
+    if (layout == MeshVertexLayout::TangentSpaceCompressed)
+    {
+        std::vector<float3> tangents, bitangents;
+        TangentGenerator::generate(vertices, indices, tangents, bitangents);
+        compress(vertices, tangents, bitangents, data);
+        data.pVertices = data.compressedVertices.data();
+    }
+    else if (layout == MeshVertexLayout::TangentSpace)
+    {
+        std::vector<float3> tangents, bitangents;
+        TangentGenerator::generate(vertices, indices, tangents, bitangents);
+        data.tangentVertices.resize(data.vertexCount);
+        for (uint32_t i = 0; i < data.vertexCount; i++)
+            data.tangentVertices[i] = {vertices[i].position, vertices[i].normal, tangents[i], bitangents[i], vertices[i].texCoord};
+        data.pVertices = data.tangentVertices.data();
+    }
+    else
+    {
+        data.pVertices = vertices.data();
+    }
+}
+
+void MeshCache::compress(
+    const TriangleMesh::VertexList& vertices,
+    const std::vector<float3>& tangents,
+    const std::vector<float3>& bitangents,
+    MeshData& data
+)
+{
+    // Positions are quantized within the bounds, the dequantization goes into the per-draw constants.
+    float3 minPos(std::numeric_limits<float>::max());
+    float3 maxPos(-std::numeric_limits<float>::max());
+    for (const auto& v : vertices)
+    {
+        minPos = min(minPos, v.position);
+        maxPos = max(maxPos, v.position);
+    }
+    if (vertices.empty())
+        minPos = maxPos = float3(0.f);
+    float3 extent = maxPos - minPos;
+    // The unorm16 attribute arrives in [0, 1] already.
+    data.positionScale = extent;
+    data.positionOffset = minPos;
+
+    data.compressedVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const TriangleMesh::Vertex& v = vertices[i];
+        CompressedTangentVertex& c = data.compressedVertices[i];
+        for (int j = 0; j < 3; j++)
+            c.position[j] = extent[j] > 0.f ? (uint16_t)std::lround((v.position[j] - minPos[j]) / extent[j] * 65535.f) : 0;
+        c.position[3] = dot(cross(v.normal, tangents[i]), bitangents[i]) < 0.f ? 0 : 0xffff;
+        encodeOctSnorm16(v.normal, c.normal);
+        encodeOctSnorm16(tangents[i], c.tangent);
+        c.texCrd[0] = floatToHalf(v.texCoord.x);
+        c.texCrd[1] = floatToHalf(v.texCoord.y);
+    }
+}
+
+void MeshCache::map(const std::filesystem::path& path, MeshVertexLayout layout, MeshData& data)
+{
+    data.pBinary = std::make_unique<BinaryMesh>(path);
+    const BinaryMesh::Header& header = data.pBinary->getHeader();
+    if (header.vertexLayout != (uint32_t)layout || header.vertexStride != getVertexStride(layout))
+        FALCOR_THROW("Binary mesh '{}' has a different vertex layout than requested.", path.string());
+    data.pVertices = data.pBinary->getVertexData();
+    data.vertexCount = header.vertexCount;
+    data.pIndices = data.pBinary->getIndexData();
+    data.indexCount = header.indexCount;
+    data.indexStride = header.indexStride;
+    data.positionScale = float3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+    data.positionOffset = float3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+}
+
+MeshCache::Mesh MeshCache::upload(const MeshData& data, MeshVertexLayout layout)
+{
+    // Straight from the parsed or mapped data into the upload, no intermediate copies.
+    ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
+    ref<Buffer> pVertexBuffer = mpDevice->createStructuredBuffer(
+        getVertexStride(layout), data.vertexCount, vbBindFlags, MemoryType::DeviceLocal, data.pVertices, false
+    );
+    ResourceBindFlags ibBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::Index;
+    bool shortIndices = data.indexStride == sizeof(uint16_t);
+    ref<Buffer> pIndexBuffer;
+    if (shortIndices)
+        pIndexBuffer = mpDevice->createTypedBuffer<uint16_t>(
+            data.indexCount, ibBindFlags, MemoryType::DeviceLocal, static_cast<const uint16_t*>(data.pIndices)
+        );
+    else
+        pIndexBuffer = mpDevice->createTypedBuffer<uint32_t>(
+            data.indexCount, ibBindFlags, MemoryType::DeviceLocal, static_cast<const uint32_t*>(data.pIndices)
+        );
+    mUploadedBytes += pVertexBuffer->getSize() + pIndexBuffer->getSize();
+
+    Mesh result;
+    ResourceFormat indexFormat = shortIndices ? ResourceFormat::R16Uint : ResourceFormat::R32Uint;
+    result.pVao = Vao::create(Vao::Topology::TriangleList, getVertexLayout(layout), {pVertexBuffer}, pIndexBuffer, indexFormat);
+    result.vertexCount = data.vertexCount;
+    result.indexCount = data.indexCount;
+    result.positionScale = data.positionScale;
+    result.positionOffset = data.positionOffset;
+    return result;
+}
+
+const ref<VertexLayout>& MeshCache::getVertexLayout(MeshVertexLayout layout)
+{
+    ref<VertexLayout>& pLayout = mVertexLayouts[layout];
+    if (pLayout)
+        return pLayout;
+
+    pLayout = VertexLayout::create();
+    ref<VertexBufferLayout> pVertexLayout = VertexBufferLayout::create();
+    if (layout == MeshVertexLayout::TangentSpaceCompressed)
+    {
+        // Same locations as TangentSpace, minus the bitangent.
+        pVertexLayout->addElement(
+            "POSITION", offsetof(CompressedTangentVertex, position), ResourceFormat::RGBA16Unorm, 1, VERTEX_POSITION_LOC
+        );
+        pVertexLayout->addElement(
+            "NORMAL", offsetof(CompressedTangentVertex, normal), ResourceFormat::RG16Snorm, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
+        );
+        pVertexLayout->addElement("TANGENT", offsetof(CompressedTangentVertex, tangent), ResourceFormat::RG16Snorm, 1, 2);
+        pVertexLayout->addElement("TEXCOORD", offsetof(CompressedTangentVertex, texCrd), ResourceFormat::RG16Float, 1, 4);
+    }
+    else if (layout == MeshVertexLayout::TangentSpace)
+    {
+        pVertexLayout->addElement("POSITION", offsetof(TangentVertex, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
+        pVertexLayout->addElement(
+            "NORMAL", offsetof(TangentVertex, normal), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
+        );
+        pVertexLayout->addElement("TANGENT", offsetof(TangentVertex, tangent), ResourceFormat::RGB32Float, 1, 2);
+        pVertexLayout->addElement("BITANGENT", offsetof(TangentVertex, bitangent), ResourceFormat::RGB32Float, 1, 3);
+        pVertexLayout->addElement("TEXCOORD", offsetof(TangentVertex, texCrd), ResourceFormat::RG32Float, 1, 4);
+    }
+    else
+    {
+        // Add the packed static vertex data layout.
+        pVertexLayout->addElement(
+            VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC
+        );
+        pVertexLayout->addElement(
+            VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME,
+            offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius),
+            ResourceFormat::RGB32Float,
+            1,
+            VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
+        );
+        pVertexLayout->addElement(
+            VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC
+        );
+    }
+    pLayout->addBufferLayout(0, pVertexLayout);
+    return pLayout;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "Falcor.h"
+#include <Scene/TriangleMesh.h>
+#include "BinaryMesh.h"
+#include "MeshOptimizer.h"
+
+using namespace Falcor;
+
+enum class MeshVertexLayout
+{
+    /// TriangleMesh::Vertex as is: POSITION, the normal in the PackedStaticVertexData normal slot, TEXCOORD.
+    Standard,
+    /// TangentVertex, with tangents from TangentGenerator for normal mapping (NormalMap, PBR).
+    TangentSpace,
+    /// CompressedTangentVertex, the quantized TangentSpace layout decoded by TangentSpaceVertex.slangh.
+    TangentSpaceCompressed,
+};
+
+/** Device-level cache of uploaded meshes, keyed by (source, vertex layout, normal smoothing).
+    A sample holds the cache of its device through get(). Repeated requests for the same (source, layout,
+    smoothNormals) within the sample share one upload and one Vao, e.g. the getMesh calls PBR repeats whenever it
+    toggles between the TangentSpace and compressed layouts.
+    The CPU copies (the TriangleMesh and the interleaved vertices) only live during the upload. get() only keeps a weak
+    reference, so the cache and its buffers are released with the sample, before the device is destroyed.
+    Parsed meshes go through MeshOptimizer before the upload, and meshes with less than 65536 vertices get 16-bit
+    indices. A mesh file that has an up to date binary conversion next to it (see convert()) is memory-mapped and
+    uploaded without parsing, the conversion is optimized already. `source` may also name a .fmesh file directly.
+ */
+class MeshCache
+{
+public:
+    struct TangentVertex
+    {
+        float3 position;
+        float3 normal;
+        float3 tangent; ///< Along dP/du.
+        float3 bitangent; ///< cross(normal, tangent), negated for mirrored UVs.
+        float2 texCrd;
+    };
+
+    /// 20 instead of 68 bytes: positions quantized to 16 bits within the mesh bounds, octahedral snorm16 normal and
+    /// tangent, half UVs. The bitangent is reconstructed as cross(normal, tangent) * handedness.
+    struct CompressedTangentVertex
+    {
+        uint16_t position[4]; ///< xyz unorm16 within the bounds, w the handedness (0 for -1, 0xffff for +1).
+        int16_t normal[2];
+        int16_t tangent[2];
+        uint16_t texCrd[2];
+    };
+
+    static_assert(sizeof(CompressedTangentVertex) == 20);
+
+    struct Mesh
+    {
+        ref<Vao> pVao;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        /// Dequantization of compressed positions, position = positionOffset + positionScale * unorm with the unorm in
+        /// [0, 1], i.e. the bounds. Identity otherwise.
+        float3 positionScale = float3(1.0f);
+        float3 positionOffset = float3(0.0f);
+    };
+
+    /// Names of the built-in TriangleMesh shapes, usable as `source`.
+    static const std::string kCube;
+    static const std::string kSphere;
+
+    /// Returns the cache of `pDevice`, creating it if no sample holds it.
+    static std::shared_ptr<MeshCache> get(const ref<Device>& pDevice);
+
+    /// `source` is a mesh file or one of kCube, kSphere. Loads and uploads it on the first request only.
+    const Mesh& getMesh(const std::string& source, MeshVertexLayout layout, bool smoothNormals = false);
+    ref<Vao> getVao(const std::string& source, MeshVertexLayout layout, bool smoothNormals = false)
+    {
+        return getMesh(source, layout, smoothNormals).pVao;
+    }
+
+    /// Converts `source` offline into the binary container getMesh() picks up instead of parsing it. CPU only.
+    /// Returns the path of the written file.
+    static std::filesystem::path convert(const std::string& source, MeshVertexLayout layout, bool smoothNormals);
+    /// Path of the binary conversion of `source`, e.g. Arcade.fbx.standard.smooth.fmesh.
+    static std::filesystem::path getBinaryPath(const std::string& source, MeshVertexLayout layout, bool smoothNormals);
+
+    uint32_t getMeshCount() const { return (uint32_t)mMeshes.size(); }
+    uint64_t getUploadedBytes() const { return mUploadedBytes; }
+
+    MeshCache(const ref<Device>& pDevice) : mpDevice(pDevice) {}
+
+private:
+    using Key = std::tuple<std::string, MeshVertexLayout, bool>;
+
+    /// Vertex and index data in the GPU upload layout, with the storage it points into.
+    struct MeshData
+    {
+        const void* pVertices = nullptr;
+        uint32_t vertexCount = 0;
+        const void* pIndices = nullptr;
+        uint32_t indexCount = 0;
+        uint32_t indexStride = 4;
+
+        float3 positionScale = float3(1.0f);
+        float3 positionOffset = float3(0.0f);
+
+        TriangleMesh::VertexList vertices;
+        TriangleMesh::IndexList indices;
+        std::vector<uint16_t> indices16;
+        std::vector<TangentVertex> tangentVertices;
+        std::vector<CompressedTangentVertex> compressedVertices;
+        std::unique_ptr<BinaryMesh> pBinary;
+    };
+
+    static uint32_t getVertexStride(MeshVertexLayout layout);
+    static void parse(const std::string& source, MeshVertexLayout layout, bool smoothNormals, MeshData& data);
+    static void compress(const TriangleMesh::VertexList& vertices, const std::vector<float3>& tangents, const std::vector<float3>& bitangents, MeshData& data);
+    static void map(const std::filesystem::path& path, MeshVertexLayout layout, MeshData& data);
+    Mesh upload(const MeshData& data, MeshVertexLayout layout);
+    const ref<VertexLayout>& getVertexLayout(MeshVertexLayout layout);
+
+    ref<Device> mpDevice;
+    std::map<Key, Mesh> mMeshes;
+    std::map<MeshVertexLayout, ref<VertexLayout>> mVertexLayouts;
+    uint64_t mUploadedBytes = 0;
+};
@@ -0,0 +1,363 @@
+#include "MeshOptimizer.h"
+#include "JobSystem.h"
+
+namespace
+{
+// Forsyth's scoring, with the constants of the original article.
+const uint32_t kForsythCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+// Smallest triangle range worth its own job and cold cache.
+const size_t kMinRangeTriangles = 1 << 16;
+
+float vertexScore(int cachePosition, uint32_t liveTriangles)
+{
+    if (liveTriangles == 0)
+        return -1.f;
+
+    float score = 0.f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+            score = kLastTriangleScore;
+        else
+            score = std::pow(1.f - float(cachePosition - 3) / float(kForsythCacheSize - 3), kCacheDecayPower);
+    }
+    return score + kValenceBoostScale * std::pow(float(liveTriangles), -kValenceBoostPower);
+}
+
+/// Forsyth's algorithm on `triangleCount` triangles with vertex ids below `vertexCount`.
+void optimizeRange(const uint32_t* pIndices, size_t triangleCount, uint32_t vertexCount, uint32_t* pResult)
+{
+    // Vertex to triangle adjacency, the first live[v] entries of each vertex are the triangles not emitted yet.
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        live[pIndices[i]]++;
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + live[v];
+    std::vector<uint32_t> adjacency(offsets[vertexCount]);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+            for (int c = 0; c < 3; c++)
+                adjacency[fill[pIndices[t * 3 + c]]++] = (uint32_t)t;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+        score[v] = vertexScore(-1, live[v]);
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    int64_t bestTriangle = -1;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const uint32_t* tri = pIndices + t * 3;
+        triangleScore[t] = score[tri[0]] + score[tri[1]] + score[tri[2]];
+        if (bestTriangle < 0 || triangleScore[t] > triangleScore[bestTriangle])
+            bestTriangle = (int64_t)t;
+    }
+
+    uint32_t cache[kForsythCacheSize + 3];
+    uint32_t cacheCount = 0;
+    size_t cursor = 0;
+    for (size_t k = 0; k < triangleCount; k++)
+    {
+        // Nothing in the cache has live triangles: continue with the next triangle in input order.
+        if (bestTriangle < 0)
+        {
+            while (emitted[cursor])
+                cursor++;
+            bestTriangle = (int64_t)cursor;
+        }
+
+        const uint32_t* tri = pIndices + bestTriangle * 3;
+        std::memcpy(pResult + k * 3, tri, 3 * sizeof(uint32_t));
+        emitted[bestTriangle] = 1;
+
+        uint32_t newCache[kForsythCacheSize + 3];
+        uint32_t newCount = 0;
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t v = tri[c];
+            uint32_t* pAdjacent = adjacency.data() + offsets[v];
+            uint32_t* pLast = pAdjacent + live[v] - 1;
+            *std::find(pAdjacent, pLast, (uint32_t)bestTriangle) = *pLast;
+            live[v]--;
+            if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                newCache[newCount++] = v;
+        }
+        for (uint32_t i = 0; i < cacheCount; i++)
+        {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                newCache[newCount++] = v;
+        }
+
+        // Vertices pushed out of the cache lose their cache score, the rest get a new position.
+        for (uint32_t i = 0; i < newCount; i++)
+        {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < kForsythCacheSize ? (int)i : -1;
+            score[v] = vertexScore(cachePosition[v], live[v]);
+        }
+
+        bestTriangle = -1;
+        float bestScore = -1.f;
+        for (uint32_t i = 0; i < newCount; i++)
+        {
+            uint32_t v = newCache[i];
+            for (uint32_t a = 0; a < live[v]; a++)
+            {
+                uint32_t t = adjacency[offsets[v] + a];
+                const uint32_t* adjacentTri = pIndices + t * 3;
+                triangleScore[t] = score[adjacentTri[0]] + score[adjacentTri[1]] + score[adjacentTri[2]];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min(newCount, kForsythCacheSize);
+        std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+    }
+}
+
+/// optimizeRange() on a range of a larger mesh, with the vertex ids compacted to those the range uses.
+void optimizeSubRange(const uint32_t* pIndices, size_t triangleCount, uint32_t* pResult)
+{
+    std::vector<uint32_t> vertices(pIndices, pIndices + triangleCount * 3);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    std::vector<uint32_t> local(triangleCount * 3);
+    for (size_t i = 0; i < local.size(); i++)
+        local[i] = (uint32_t)(std::lower_bound(vertices.begin(), vertices.end(), pIndices[i]) - vertices.begin());
+    optimizeRange(local.data(), triangleCount, (uint32_t)vertices.size(), pResult);
+    for (size_t i = 0; i < local.size(); i++)
+        pResult[i] = vertices[pResult[i]];
+}
+
+/// Simulates a FIFO cache of `cacheSize` vertices. `timestamps` holds per vertex the miss counter at its last miss.
+struct FifoCache
+{
+    std::vector<uint32_t> timestamps;
+    uint32_t misses = 0;
+    uint32_t cacheSize;
+
+    FifoCache(uint32_t vertexCount, uint32_t size) : timestamps(vertexCount, 0), cacheSize(size) {}
+
+    /// Returns true on a miss.
+    bool access(uint32_t v)
+    {
+        // Timestamps start at cacheSize + 1 so that the initial 0 is always out of the cache.
+        uint32_t now = misses + cacheSize + 1;
+        if (now - timestamps[v] <= cacheSize)
+            return false;
+        timestamps[v] = now;
+        misses++;
+        return true;
+    }
+    void reset() { misses += cacheSize + 1; }
+};
+} // namespace
+
+std::pair<VertexCacheStats, VertexCacheStats> MeshOptimizer::optimize(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices)
+{
+    uint32_t vertexCount = (uint32_t)vertices.size();
+    VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+    optimizeVertexCache(indices, vertices);
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(indices, vertices);
+    return {before, analyzeVertexCache(indices, vertexCount)};
+}
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    for (uint32_t v : indices)
+    {
+        cache.access(v);
+        referenced[v] = 1;
+    }
+
+    VertexCacheStats stats;
+    size_t triangleCount = indices.size() / 3;
+    size_t referencedCount = std::count(referenced.begin(), referenced.end(), uint8_t(1));
+    stats.acmr = triangleCount ? float(cache.misses) / triangleCount : 0.f;
+    stats.atvr = referencedCount ? float(cache.misses) / referencedCount : 0.f;
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, const TriangleMesh::VertexList& vertices, uint32_t threadCount)
+{
+    uint32_t vertexCount = (uint32_t)vertices.size();
+    size_t triangleCount = indices.size() / 3;
+    // Meshes too small to split skip the slab sort, parallelFor() would run them as a single range anyway.
+    size_t maxRanges = threadCount ? threadCount : JobSystem::get().getThreadCount() + 1;
+    bool split = std::min(maxRanges, triangleCount / kMinRangeTriangles) > 1;
+
+    std::vector<uint32_t> result(indices.size());
+    if (!split)
+    {
+        optimizeRange(indices.data(), triangleCount, vertexCount, result.data());
+    }
+    else
+    {
+        // Importer order is not necessarily spatially coherent, so the ranges are slabs along the longest axis.
+        float3 minPos(std::numeric_limits<float>::max()), maxPos(-std::numeric_limits<float>::max());
+        for (const auto& v : vertices)
+        {
+            minPos = min(minPos, v.position);
+            maxPos = max(maxPos, v.position);
+        }
+        float3 extent = maxPos - minPos;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        std::vector<float> keys(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+            keys[t] = vertices[indices[t * 3]].position[axis] + vertices[indices[t * 3 + 1]].position[axis] +
+                      vertices[indices[t * 3 + 2]].position[axis];
+        std::vector<uint32_t> order(triangleCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        for (size_t t = 0; t < triangleCount; t++)
+            std::memcpy(result.data() + t * 3, indices.data() + order[t] * 3, 3 * sizeof(uint32_t));
+        indices.swap(result);
+
+        JobSystem::get().parallelFor(
+            triangleCount,
+            threadCount,
+            kMinRangeTriangles,
+            1,
+            [&](size_t begin, size_t end) { optimizeSubRange(indices.data() + begin * 3, end - begin, result.data() + begin * 3); }
+        );
+    }
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const TriangleMesh::VertexList& vertices, float threshold)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Hard boundaries: triangles that miss on all three vertices, the cache is effectively cold there anyway.
+    // The first triangle always starts a cluster, it may hit on its own vertices if it is degenerate.
+    std::vector<size_t> hardClusters = {0};
+    {
+        FifoCache cache((uint32_t)vertices.size(), kStatsCacheSize);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t misses = cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+            if (misses == 3 && t > 0)
+                hardClusters.push_back(t);
+        }
+        hardClusters.push_back(triangleCount);
+    }
+
+    // Soft boundaries: split a hard cluster wherever the part since the last split, started with a cold cache, is
+    // within `threshold` of the ACMR of the whole hard cluster.
+    std::vector<size_t> clusters;
+    {
+        FifoCache cache((uint32_t)vertices.size(), kStatsCacheSize);
+        for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+        {
+            size_t begin = hardClusters[c], end = hardClusters[c + 1];
+            cache.reset();
+            uint32_t start = cache.misses;
+            for (size_t t = begin; t < end; t++)
+                for (int i = 0; i < 3; i++)
+                    cache.access(indices[t * 3 + i]);
+            float limit = threshold * float(cache.misses - start) / float(end - begin);
+
+            cache.reset();
+            start = cache.misses;
+            size_t splitBegin = begin;
+            clusters.push_back(begin);
+            for (size_t t = begin; t < end; t++)
+            {
+                for (int i = 0; i < 3; i++)
+                    cache.access(indices[t * 3 + i]);
+                if (t + 1 < end && float(cache.misses - start) / float(t + 1 - splitBegin) <= limit)
+                {
+                    clusters.push_back(t + 1);
+                    splitBegin = t + 1;
+                    cache.reset();
+                    start = cache.misses;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+
+    // Area weighted centroid and normal of every cluster.
+    size_t clusterCount = clusters.size() - 1;
+    std::vector<float3> centroids(clusterCount), normals(clusterCount);
+    float3 meshCentroid(0.f);
+    float meshArea = 0.f;
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        float3 centroid(0.f), normal(0.f);
+        float area = 0.f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+        {
+            float3 p0 = vertices[indices[t * 3]].position;
+            float3 p1 = vertices[indices[t * 3 + 1]].position;
+            float3 p2 = vertices[indices[t * 3 + 2]].position;
+            float3 n = cross(p1 - p0, p2 - p0);
+            float a = length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.f);
+            normal += n;
+            area += a;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids[c] = area > 0.f ? centroid / area : vertices[indices[clusters[c] * 3]].position;
+        float normalLength = length(normal);
+        normals[c] = normalLength > 0.f ? normal / normalLength : float3(0.f);
+    }
+    if (meshArea > 0.f)
+        meshCentroid /= meshArea;
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++)
+        sortKeys[c] = dot(centroids[c] - meshCentroid, normals[c]);
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order)
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    FALCOR_ASSERT(result.size() == triangleCount * 3);
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, TriangleMesh::VertexList& vertices)
+{
+    const uint32_t kUnused = ~0u;
+    std::vector<uint32_t> remap(vertices.size(), kUnused);
+    uint32_t next = 0;
+    for (uint32_t& v : indices)
+    {
+        if (remap[v] == kUnused)
+            remap[v] = next++;
+        v = remap[v];
+    }
+    for (uint32_t& r : remap)
+        if (r == kUnused)
+            r = next++;
+
+    TriangleMesh::VertexList result(vertices.size());
+    for (size_t v = 0; v < vertices.size(); v++)
+        result[remap[v]] = vertices[v];
+    vertices.swap(result);
+}
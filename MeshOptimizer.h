@@ -0,0 +1,45 @@
+#pragma once
+#include "Falcor.h"
+#include <Scene/TriangleMesh.h>
+
+using namespace Falcor;
+
+/** Post-transform vertex cache statistics of an index buffer, from a simulated FIFO cache.
+    ACMR is the average number of cache misses (vertex shader invocations) per triangle, 0.5 at best for large
+    regular meshes and 3 at worst. ATVR is the number of misses per referenced vertex, 1 at best.
+ */
+struct VertexCacheStats
+{
+    float acmr = 0.f;
+    float atvr = 0.f;
+};
+
+/** Index and vertex reordering for rendering, applied by MeshCache when a mesh is parsed.
+    optimize() runs the three stages in order:
+    - optimizeVertexCache(): Forsyth's linear-speed vertex cache optimization. Large meshes are split into spatial
+      slabs of triangles that are optimized as JobSystem::parallelFor() ranges, which costs a cold cache per slab.
+    - optimizeOverdraw(): splits the cache-optimized order into clusters where the cache locality allows it (Sander
+      et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw") and sorts the clusters so the
+      ones facing away from the mesh center, likely occluders, are drawn first.
+    - optimizeVertexFetch(): renumbers the vertices in the order of first use, so vertex fetches walk the vertex
+      buffer linearly.
+ */
+class MeshOptimizer
+{
+public:
+    /// FIFO cache size of the statistics, that of the older GPUs the optimization targets.
+    static const uint32_t kStatsCacheSize = 16;
+
+    /// Reorders `vertices` and `indices` in place. Returns the cache statistics before and after.
+    static std::pair<VertexCacheStats, VertexCacheStats> optimize(TriangleMesh::VertexList& vertices, TriangleMesh::IndexList& indices);
+
+    static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = kStatsCacheSize);
+
+    /// `vertices` only places the triangle ranges of large meshes. `threadCount` includes the caller's thread, 0 uses
+    /// all JobSystem workers.
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, const TriangleMesh::VertexList& vertices, uint32_t threadCount = 0);
+    /// `threshold` is the ACMR a cluster may lose relative to the input order, 1.05 keeps it within 5%.
+    static void optimizeOverdraw(std::vector<uint32_t>& indices, const TriangleMesh::VertexList& vertices, float threshold = 1.05f);
+    /// Renumbers the vertices and reorders `vertices` to match. Unreferenced vertices move to the end.
+    static void optimizeVertexFetch(std::vector<uint32_t>& indices, TriangleMesh::VertexList& vertices);
+};
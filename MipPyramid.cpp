@@ -0,0 +1,84 @@
+#include "MipPyramid.h"
+
+namespace
+{
+// Must match MipPyramid.cs.slang.
+const uint32_t kGroupSize = 256;
+const uint32_t kTileSize = 64;
+const uint32_t kLevelsPerPass = 6;
+} // namespace
+
+MipPyramid::MipPyramid(const ref<Device>& pDevice, ResourceFormat format, Reduction reduction)
+    : mpDevice(pDevice), mFormat(format), mReduction(reduction)
+{
+    DefineList defines;
+    defines.add("MIP_PYRAMID_REDUCTION", std::to_string((uint32_t)reduction));
+    if (reduction == Reduction::Binomial)
+    {
+        mpPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/MipPyramid.cs.slang", "downsampleBinomial", defines);
+        Sampler::Desc samplerDesc;
+        samplerDesc.setFilterMode(TextureFilteringMode::Linear, TextureFilteringMode::Linear, TextureFilteringMode::Point)
+            .setAddressingMode(TextureAddressingMode::Clamp, TextureAddressingMode::Clamp, TextureAddressingMode::Clamp);
+        mpLinearSampler = pDevice->createSampler(samplerDesc);
+    }
+    else
+    {
+        mpPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/MipPyramid.cs.slang", "main", defines);
+        uint32_t zero = 0;
+        mpCounter = pDevice->createBuffer(sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, &zero);
+    }
+}
+
+void MipPyramid::build(RenderContext* pRenderContext, const ref<Texture>& pSrc, uint32_t levelCount)
+{
+    FALCOR_PROFILE(pRenderContext, "MipPyramid");
+
+    uint2 srcSize = uint2(pSrc->getWidth(), pSrc->getHeight());
+    uint32_t width = std::max(1u, srcSize.x / 2), height = std::max(1u, srcSize.y / 2);
+    uint32_t fullChain = 0;
+    while ((std::max(width, height) >> fullChain) > 0)
+        fullChain++;
+    fullChain = std::min(fullChain, kMaxLevels);
+    levelCount = levelCount == 0 ? fullChain : std::min(levelCount, fullChain);
+    if (mReduction != Reduction::Binomial && levelCount > kLevelsPerPass && std::max(srcSize.x, srcSize.y) > kTileSize * kTileSize)
+        FALCOR_THROW("MipPyramid: more than {} levels need a source of at most {}x{}.", kLevelsPerPass, kTileSize * kTileSize, kTileSize * kTileSize);
+
+    if (!mpTexture || mpTexture->getWidth() != width || mpTexture->getHeight() != height || mpTexture->getMipCount() != levelCount)
+    {
+        mpTexture = mpDevice->createTexture2D(
+            width, height, mFormat, 1, levelCount, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+        );
+    }
+
+    if (mReduction == Reduction::Binomial)
+    {
+        buildBinomial(pRenderContext, pSrc, levelCount);
+        return;
+    }
+
+    uint2 groupCount = (srcSize + kTileSize - 1) / kTileSize;
+    ShaderVar var = mpPass->getRootVar();
+    var["PerFrameCB"]["gSrcSize"] = srcSize;
+    var["PerFrameCB"]["gLevelCount"] = levelCount;
+    var["PerFrameCB"]["gGroupCount"] = groupCount.x * groupCount.y;
+    var["gSrc"] = pSrc;
+    for (uint32_t level = 0; level < levelCount; level++)
+        var["gLevels"][level].setUav(mpTexture->getUAV(level, 0, 1));
+    var["gCounter"] = mpCounter;
+    // One group per 64x64 tile of the source, execute() takes thread counts.
+    mpPass->execute(pRenderContext, uint3(groupCount.x * kGroupSize, groupCount.y, 1));
+}
+
+void MipPyramid::buildBinomial(RenderContext* pRenderContext, const ref<Texture>& pSrc, uint32_t levelCount)
+{
+    ShaderVar var = mpPass->getRootVar();
+    var["gLinearSampler"] = mpLinearSampler;
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        uint2 dstSize = uint2(mpTexture->getWidth(level), mpTexture->getHeight(level));
+        var["LevelCB"]["gDstSize"] = dstSize;
+        var["gSrcLevel"].setSrv(level == 0 ? pSrc->getSRV(0, 1, 0, 1) : mpTexture->getSRV(level - 1, 1, 0, 1));
+        var["gDstLevel"].setUav(mpTexture->getUAV(level, 0, 1));
+        mpPass->execute(pRenderContext, uint3(dstSize, 1));
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Falcor.h"
+#include "Core/Pass/ComputePass.h"
+
+using namespace Falcor;
+
+/** Mip pyramid of a texture built in a single compute dispatch, the pyramid of the SSAO sample's blur demo.
+    Level 0 is half the size of the source and every level reduces the 2x2 texels it covers in the level above,
+    by average, min or max. Up to 6 levels are built entirely in groupshared memory. Longer chains are finished by the
+    last group of the dispatch, which limits them to sources of at most 4096x4096.
+    The binomial reduction filters a 10x10 footprint instead, which is smoother but not local to the tiles of the
+    single dispatch, so it takes one dispatch per level and has no size limit. It is an opt-in for image quality.
+    The Hi-Z of occlusion culling keeps HiZPyramid: its odd-sized levels extend the footprint of their last texel to
+    three texels to stay conservative, which fixed 2x2 reductions cannot do.
+ */
+class MipPyramid
+{
+public:
+    enum class Reduction : uint32_t
+    {
+        Average,
+        Min,
+        Max,
+        Binomial,
+    };
+
+    static const uint32_t kMaxLevels = 12;
+
+    MipPyramid(const ref<Device>& pDevice, ResourceFormat format, Reduction reduction = Reduction::Average);
+
+    /// Rebuilds the first `levelCount` levels from `pSrc`, all of them for 0, reallocating the pyramid when needed.
+    void build(RenderContext* pRenderContext, const ref<Texture>& pSrc, uint32_t levelCount = 0);
+    Reduction getReduction() const { return mReduction; }
+
+    const ref<Texture>& getTexture() const { return mpTexture; }
+    bool isValid() const { return mpTexture != nullptr; }
+
+private:
+    void buildBinomial(RenderContext* pRenderContext, const ref<Texture>& pSrc, uint32_t levelCount);
+
+    ref<Device> mpDevice;
+    ResourceFormat mFormat;
+    Reduction mReduction;
+    ref<ComputePass> mpPass;
+    ref<Sampler> mpLinearSampler; ///< Binomial only.
+    ref<Buffer> mpCounter;
+    ref<Texture> mpTexture;
+};
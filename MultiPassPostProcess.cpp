@@ -29,6 +29,23 @@ void MultiPassPostProcess::onLoad(const SampleAppConfig& config,const ref<Device
 void MultiPassPostProcess::onResize(uint32_t width, uint32_t height)
 {
     mAspectRatio = (float(width) / float(height));
+    if (width == screenWidth && height == screenHeight)
+        return;
+    screenWidth = width;
+    screenHeight = height;
+    for (PassHandle handle = 0; handle < mPasses.size(); handle++)
+    {
+        Pass& pass = mPasses[handle];
+        if (!pass.fbo)
+            continue;
+        ref<Texture> pOld = pass.fbo->getColorTexture(0);
+        if (!pOld || handle == mOutputPass)
+            continue;
+        ref<Texture> tex = device->createTexture2D(
+            width, height, pOld->getFormat(), 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
+        );
+        pass.fbo->attachColorTarget(tex, 0);
+    }
 }
 
 //void MultiPassPostProcess::setToyShaderParameter(const Pass& pass)
@@ -38,7 +55,17 @@ void MultiPassPostProcess::onResize(uint32_t width, uint32_t height)
 //        var["iGlobalTime"] = time;
 //        var["gSampler"] = mpLinearSampler;
 //}
-void MultiPassPostProcess::addPass(const std::string& passName, const std::string& shaderFile,bool createColorTexture)
+MultiPassPostProcess::PassHandle MultiPassPostProcess::findPass(const std::string& passName) const
+{
+    for (PassHandle handle = 0; handle < mPasses.size(); handle++)
+    {
+        if (mPasses[handle].name == passName)
+            return handle;
+    }
+    FALCOR_THROW("Post process '{}' has no pass named '{}'.", getName(), passName);
+}
+
+MultiPassPostProcess::PassHandle MultiPassPostProcess::addPass(const std::string& passName, const std::string& shaderFile,bool createColorTexture)
 {
     ref<FullScreenPass> shaderPass = FullScreenPass::create(device, shaderFile);
     ref<Fbo> fbo = Fbo::create(device);
@@ -55,6 +82,72 @@ void MultiPassPostProcess::addPass(const std::string& passName, const std::strin
         );
         fbo->attachColorTarget(tex, 0);
     }
-    Pass pass{shaderPass, fbo};
-    mpPass.emplace(passName, pass);
+    mPasses.push_back({passName, shaderPass, fbo});
+    return (PassHandle)(mPasses.size() - 1);
+}
+
+MultiPassPostProcess::PassHandle MultiPassPostProcess::addOutputPass(const std::string& passName, const std::string& shaderFile)
+{
+    FALCOR_ASSERT(mOutputPass == kInvalidPass);
+    mOutputPass = addPass(passName, shaderFile, false);
+    return mOutputPass;
+}
+
+MultiPassPostProcess::PassHandle MultiPassPostProcess::addComputeOutputPass(const std::string& passName, const std::string& shaderFile, uint32_t rowThreads)
+{
+    FALCOR_ASSERT(mComputeOutputPass == kInvalidPass);
+    Pass pass;
+    pass.name = passName;
+    pass.computePass = ComputePass::create(device, shaderFile);
+    pass.output = pass.computePass->getRootVar()["gOutput"];
+    pass.rowThreads = rowThreads;
+    mPasses.push_back(pass);
+    mComputeOutputPass = (PassHandle)(mPasses.size() - 1);
+    return mComputeOutputPass;
+}
+
+void MultiPassPostProcess::refreshVars()
+{
+    bool changed = mResolvedVersions.size() != mPasses.size();
+    mResolvedVersions.resize(mPasses.size());
+    for (size_t i = 0; i < mPasses.size(); i++)
+    {
+        const Pass& pass = mPasses[i];
+        const ref<Program>& pProgram = pass.computePass ? pass.computePass->getProgram() : pass.pass->getProgram();
+        const ref<const ProgramVersion>& pVersion = pProgram->getActiveVersion();
+        changed |= pVersion != mResolvedVersions[i];
+        mResolvedVersions[i] = pVersion;
+    }
+    if (!changed)
+        return;
+
+    for (auto& pass : mPasses)
+    {
+        if (pass.computePass)
+            pass.output = pass.computePass->getRootVar()["gOutput"];
+    }
+    if (mpComputeOutput && supportsCompute())
+        mPasses[mComputeOutputPass].output = mpComputeOutput;
+    resolveVars();
+}
+
+ResourceBindFlags MultiPassPostProcess::getOutputBindFlags() const
+{
+    ResourceBindFlags flags = ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget;
+    if (isComputeActive())
+        flags |= ResourceBindFlags::UnorderedAccess;
+    return flags;
+}
+
+void MultiPassPostProcess::setOutput(const ref<Texture>& pOutput)
+{
+    if (isComputeActive())
+    {
+        mpComputeOutput = pOutput;
+        mPasses[mComputeOutputPass].output = pOutput;
+    }
+    else
+    {
+        mPasses[mOutputPass].fbo->attachColorTarget(pOutput, 0);
+    }
 }
@@ -2,6 +2,8 @@
 #include "Falcor.h"
 #include "SampleAppTemplate.h"
 #include "Core/Pass/FullScreenPass.h"
+#include "Core/Pass/ComputePass.h"
+#include "PassProfiler.h"
 
 using namespace Falcor;
 
@@ -10,11 +12,20 @@ class MultiPassPostProcess
 public:
     struct Pass
     {
+        std::string name;
         ref<FullScreenPass> pass;
         ref<Fbo> fbo;
+        /// Set instead of `pass` and `fbo` for compute passes, which write their output through `output`.
+        ref<ComputePass> computePass;
+        ShaderVar output;
+        /// Threads per output row for compute passes whose groups loop over a whole row, 0 for one thread per pixel.
+        uint32_t rowThreads = 0;
     };
+    /// Index of a pass, returned by addPass() at load time so the per-frame path never looks passes up by name.
+    using PassHandle = uint32_t;
 
     virtual void onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext);
+    /// Reallocates the color targets of all passes, `width` and `height` are the resolution of the processed image.
     virtual void onResize(uint32_t width, uint32_t height);
     virtual void onFrameRender(
         RenderContext* pRenderContext,
@@ -24,21 +35,59 @@ public:
         ref<Texture> normalWS,
         ref<Texture> posWS
     )=0;
+    /// Binds the per-frame parameters of all passes. Shader variables are resolved once per program version, so this
+    /// does no string lookups.
+    virtual void bindParameters(float time, const ref<Texture>& color) = 0;
+    /// Resolves the shader variables the effect caches and binds the parameters that never change, e.g. samplers.
+    virtual void resolveVars() {}
+    /// Calls resolveVars() when a program of the effect has a new version, e.g. after a shader hot reload, which leaves
+    /// the cached variables pointing into the old layout. Only compares pointers, call it before binding.
+    void refreshVars();
     virtual void onGui(Gui* pGui) {}
+    /// Name of the effect, used as its scope in the pass timings.
+    virtual std::string getName() const = 0;
+    void setProfiler(PassProfiler* pProfiler) { mpProfiler = pProfiler; }
+    /// Pointwise effects only read the pixel they write, so consecutive ones can be fused into UberPost.ps.slang.
+    virtual bool isPointwise() const { return false; }
+    /// Define enabling the effect in UberPost.ps.slang. Only used for pointwise effects.
+    virtual std::string getUberDefine() const { return {}; }
+    /// Binds the effect's parameters to the PerFrameCB of the fused pass. Only used for pointwise effects.
+    virtual void setUberParameters(const ShaderVar& var, float time) {}
     ShaderVar getRootVar(const ref<FullScreenPass>& pass) { return pass->getRootVar()["PerFrameCB"]; }
-    ref<FullScreenPass> getPass(const std::string& passName) { return mpPass[passName].pass; }
-    ref<Fbo> getFbo(const std::string& passName) { return mpPass[passName].fbo; }
-    ref<Texture> getTexture(const std::string& passName) { return mpPass[passName].fbo->getColorTexture(0); }
+    const Pass& getPass(PassHandle handle) const { return mPasses[handle]; }
+    /// Name based lookup, for load time only.
+    PassHandle findPass(const std::string& passName) const;
+    ref<Texture> getTexture(PassHandle handle) const { return mPasses[handle].fbo->getColorTexture(0); }
 
     //void setToyShaderParameter(const Pass& pass);
-    void addPass(const std::string& passName, const std::string& shaderFile, bool createColorTexture = true);
-    void executePass(const Pass& pass, RenderContext* pRenderContext) { pass.pass->execute(pRenderContext, pass.fbo); }
-    void executePass(const std::string& passName, RenderContext* pRenderContext)
+    PassHandle addPass(const std::string& passName, const std::string& shaderFile, bool createColorTexture = true);
+    /// Adds the pass producing the effect's result. Its target is not owned by the effect but set by the chain through setOutput().
+    PassHandle addOutputPass(const std::string& passName, const std::string& shaderFile);
+    /// Adds a compute variant of the output pass, used instead of it while `useCompute` is set.
+    /// The shader writes the result to `RWTexture2D gOutput`, one thread per pixel unless `rowThreads` is set, in
+    /// which case one group of `rowThreads` threads is dispatched per row.
+    PassHandle addComputeOutputPass(const std::string& passName, const std::string& shaderFile, uint32_t rowThreads = 0);
+    bool supportsCompute() const { return mComputeOutputPass != kInvalidPass; }
+    bool isComputeActive() const { return useCompute && supportsCompute(); }
+    /// The output pass of the active backend.
+    PassHandle getOutputPass() const { return isComputeActive() ? mComputeOutputPass : mOutputPass; }
+    /// Format and bind flags the target passed to setOutput() needs. sRGB formats have no UAVs, so the compute backend writes RGBA16Float.
+    ResourceFormat getOutputFormat() const { return isComputeActive() ? ResourceFormat::RGBA16Float : ResourceFormat::RGBA8UnormSrgb; }
+    ResourceBindFlags getOutputBindFlags() const;
+    void setOutput(const ref<Texture>& pOutput);
+    void executePass(const Pass& pass, RenderContext* pRenderContext)
     {
-        auto& pass = mpPass[passName];
-        pass.pass->execute(pRenderContext, pass.fbo);
+        PASS_PROFILE(mpProfiler, pRenderContext, pass.name);
+        if (pass.computePass)
+        {
+            uint32_t width = pass.rowThreads ? pass.rowThreads : mpComputeOutput->getWidth();
+            pass.computePass->execute(pRenderContext, uint3(width, mpComputeOutput->getHeight(), 1));
+        }
+        else
+            pass.pass->execute(pRenderContext, pass.fbo);
     }
-    virtual ref<Texture> getFinalColor() = 0;
+    void executePass(PassHandle handle, RenderContext* pRenderContext) { executePass(mPasses[handle], pRenderContext); }
+    ref<Texture> getFinalColor() const { return isComputeActive() ? mpComputeOutput : getTexture(mOutputPass); }
 
     ref<Device> device;
     RenderContext* renderContext;
@@ -47,6 +96,16 @@ public:
     ref<RasterizerState> mpNoCullRastState;
     ref<DepthStencilState> mpNoDepthDS;
     ref<BlendState> mpOpaqueBS;
-    uint32_t screenHeight, screenWidth;
-    std::map<std::string, Pass> mpPass;
+    uint32_t screenHeight = 0, screenWidth = 0;
+    std::vector<Pass> mPasses;
+    static const PassHandle kInvalidPass = ~0u;
+    PassHandle mOutputPass = kInvalidPass;
+    PassHandle mComputeOutputPass = kInvalidPass;
+    ref<Texture> mpComputeOutput;
+    PassProfiler* mpProfiler = nullptr;
+    /// Program version of every pass when the cached variables were last resolved.
+    std::vector<ref<const ProgramVersion>> mResolvedVersions;
+    bool enabled = true;
+    /// Selects the compute backend for effects that have one.
+    bool useCompute = false;
 };
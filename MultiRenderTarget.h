@@ -2,7 +2,7 @@
 #include "Falcor.h"
 #include "Core/SampleApp.h"
 #include "Core/Pass/RasterPass.h"
-#include <Scene/TriangleMesh.h>
+#include "MeshCache.h"
 using namespace Falcor;
 
 class MultiRenderTarget : public SampleApp
@@ -19,10 +19,9 @@ private:
     const std::string kViewProjMatrices = "viewProjMatrices";
     const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
     const std::string kWorldMatrices = "worldMatrices";
-    static ref<Vao> createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh);
-    ref<TriangleMesh> tringleMesh[3];
     ref<RasterPass> mpRasterPass;
     ref<Vao> mpVao[3];
+    std::shared_ptr<MeshCache> mpMeshCache;
     ref<Fbo> mpFbo;
     ref<ProgramVars> mpVars;
     ref<DepthStencilState> mpDepthStencil;
@@ -6,109 +6,11 @@ PBR::PBR(const SampleAppConfig& config) : SampleApp(config) {}
 
 PBR::~PBR() {}
 
-ref<Vao> PBR::createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh)
-{
-    ref<VertexLayout> pLayout = VertexLayout::create();
-
-    // Add the packed static vertex data layout.
-    ref<VertexBufferLayout> pVertexLayout = VertexBufferLayout::create();
-    pVertexLayout->addElement("POSITION", offsetof(VertexInput, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
-    pVertexLayout->addElement(
-        "NORMAL", offsetof(VertexInput, normal), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
-    );
-    pVertexLayout->addElement("TANGENT", offsetof(VertexInput, tangent), ResourceFormat::RGB32Float, 1, 2);
-    pVertexLayout->addElement("BITANGENT", offsetof(VertexInput, bitangent), ResourceFormat::RGB32Float, 1, 3);
-    pVertexLayout->addElement("TEXCOORD", offsetof(VertexInput, texCrd), ResourceFormat::RG32Float, 1, 4);
-    pLayout->addBufferLayout(0, pVertexLayout);
-    ref<Buffer> pVertexBuffer;
-    const TriangleMesh::VertexList& vertices = mesh->getVertices();
-    const TriangleMesh::IndexList& indices = mesh->getIndices();
-
-    uint32_t vertexCount = vertices.size();
-    std::vector<float3> tangent, bitangent;
-    generateTangent(vertices, indices, tangent, bitangent);
-
-    VertexInput* vertexInput = new VertexInput[vertexCount];
-    for (uint32_t i = 0; i < vertexCount; i++)
-    {
-        vertexInput[i].position = vertices[i].position;
-        vertexInput[i].normal = vertices[i].normal;
-        vertexInput[i].tangent = tangent[i];
-        vertexInput[i].bitangent = bitangent[i];
-        vertexInput[i].texCrd = vertices[i].texCoord;
-    }
-
-    ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
-    pVertexBuffer =
-        device->createStructuredBuffer(sizeof(VertexInput), vertexCount, vbBindFlags, MemoryType::DeviceLocal, vertexInput, false);
-    uint32_t indexCount = indices.size();
-    auto indexBuffer = device->createTypedBuffer<uint32_t>(
-        indexCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::Index, MemoryType::DeviceLocal, indices.data()
-    );
-
-    // Create VAO
-    return Vao::create(Vao::Topology::TriangleList, pLayout, {pVertexBuffer}, indexBuffer, ResourceFormat::R32Uint);
-}
-
-void PBR::generateTangent(
-    const TriangleMesh::VertexList& vertexList,
-    const TriangleMesh::IndexList& indicesList,
-    std::vector<float3>& tangents,
-    std::vector<float3>& bitangents
-)
-{
-    tangents.resize(vertexList.size());
-    bitangents.resize(vertexList.size());
-    for (unsigned int i = 0; i < indicesList.size(); i += 3)
-    {
-        size_t i0 = indicesList[i];
-        size_t i1 = indicesList[i + 1];
-        size_t i2 = indicesList[i + 2];
-
-        float3 e1 = vertexList[i1].position - vertexList[i0].position;
-        float3 e2 = vertexList[i2].position - vertexList[i0].position;
-        float delta_u1 = vertexList[i1].texCoord[0] - vertexList[i0].texCoord[0];
-        float delta_u2 = vertexList[i2].texCoord[0] - vertexList[i0].texCoord[0];
-        float delta_v1 = vertexList[i1].texCoord[1] - vertexList[i0].texCoord[1];
-        float delta_v2 = vertexList[i2].texCoord[1] - vertexList[i0].texCoord[1];
-        float3 tangent = (delta_v1 * e2 - delta_v2 * e1) / (delta_v1 * delta_u2 - delta_v2 * delta_u1);
-        float3 bitangent = (-delta_u1 * e2 + delta_u2 * e1) / (delta_v1 * delta_u2 - delta_v2 * delta_u1);
-
-        tangents[i0] = (tangent);
-        tangents[i1] = (tangent);
-        tangents[i2] = (tangent);
-
-        // Same thing for binormals
-        bitangents[i0] = (bitangent);
-        bitangents[i1] = (bitangent);
-        bitangents[i2] = (bitangent);
-    }
-
-    // See "Going Further"
-    for (size_t i = 0; i < indicesList.size(); i += 1)
-    {
-        size_t index = indicesList[i];
-        const float3& n = vertexList[index].normal;
-        float3& t = tangents[index];
-        float3& b = bitangents[index];
-
-        // Gram-Schmidt orthogonalize
-        t = math::normalize(t - n * math::dot(n, t));
-
-        // Calculate handedness
-        if (math::dot(math::cross(n, t), b) < 0.0f)
-        {
-            t = t * -1.0f;
-        }
-    }
-}
-
 void PBR::postProcess(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo, const ref<Texture>& rt) {}
 
 void PBR::rasterize(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
 {
     mpRasterPass->getState()->setFbo(mpRasterFbo);
-    mpRasterPass->getState()->setVao(mpVao[0]);
     mpRasterPass->getState()->setDepthStencilState(mpDepthStencil);
     mpRasterPass->getState()->setRasterizerState(mpRasterizeState[0]);
     mpRasterPass->getState()->setProgram(mpRasterProgram);
@@ -134,11 +36,10 @@ void PBR::rasterize(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
     var["PerFrameCB"]["normalMap"] = mpNormalMap;
     var["PerFrameCB"]["metallicMap"] = mpMetallicMap;
     var["PerFrameCB"]["roughnessMap"] = mpRoughnessMap;
-    mpRasterPass->drawIndexed(pRenderContext, mpVao[0]->getIndexBuffer()->getElementCount(), 0, 0);
+    drawMesh(pRenderContext, var, mMeshes[0]);
 
-    mpRasterPass->getState()->setVao(mpVao[1]);
     var["PerFrameCB"][kWorldMatrices] = math::translate(modelMatrix, float3(2.0, 0, 0));
-    mpRasterPass->drawIndexed(pRenderContext, mpVao[1]->getIndexBuffer()->getElementCount(), 0, 0);
+    drawMesh(pRenderContext, var, mMeshes[1]);
 
     pRenderContext->blit(mpRasterFbo->getColorTexture(0)->getSRV(), pTargetFbo->getRenderTargetView(0));
 }
@@ -146,7 +47,7 @@ void PBR::rasterize(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
 void PBR::drawSkybox(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
 {
     mpRasterPass->getState()->setFbo(mpRasterFbo);
-    mpRasterPass->getState()->setVao(mpVao[2]); // Skybox using cube as vertex input
+    mpRasterPass->getState()->setVao(mMeshes[2].pVao); // Skybox using cube as vertex input
     mpRasterPass->getState()->setDepthStencilState(mpSkyboxDepthStencil);
     mpRasterPass->getState()->setRasterizerState(mpSkyboxRasterizeState);
     mpRasterPass->getState()->setProgram(mpEnvProgram);
@@ -160,7 +61,27 @@ void PBR::drawSkybox(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
     rootVar["gProjMat"] = mpCamera->getProjMatrix();
     if (mpEnvMap)
         mpEnvMap->bindShaderData(rootVar["envMap"]);
-    mpRasterPass->drawIndexed(pRenderContext, mpVao[2]->getIndexBuffer()->getElementCount(), 0, 0);
+    mpRasterPass->drawIndexed(pRenderContext, mMeshes[2].indexCount, 0, 0);
+}
+
+void PBR::loadMeshes()
+{
+    MeshVertexLayout layout = mCompressedVertices ? MeshVertexLayout::TangentSpaceCompressed : MeshVertexLayout::TangentSpace;
+    if (mCompressedVertices)
+        mpRasterProgram->addDefine("COMPRESSED_VERTICES");
+    else
+        mpRasterProgram->removeDefine("COMPRESSED_VERTICES");
+    mpVars = ProgramVars::create(getDevice(), mpRasterProgram->getReflector());
+    mMeshes[0] = mpMeshCache->getMesh(MeshCache::kSphere, layout);
+    mMeshes[1] = mpMeshCache->getMesh(MeshCache::kCube, layout);
+}
+
+void PBR::drawMesh(RenderContext* pRenderContext, const ShaderVar& var, const MeshCache::Mesh& mesh)
+{
+    mpRasterPass->getState()->setVao(mesh.pVao);
+    var["PerFrameCB"]["positionScale"] = mesh.positionScale;
+    var["PerFrameCB"]["positionOffset"] = mesh.positionOffset;
+    mpRasterPass->drawIndexed(pRenderContext, mesh.indexCount, 0, 0);
 }
 
 void PBR::onLoad(RenderContext* pRenderContext)
@@ -169,15 +90,11 @@ void PBR::onLoad(RenderContext* pRenderContext)
     // Load program
     mpRasterPass = RasterPass::create(device, "Samples/SampleAppTemplate/PBR.3d.slang", "vsMain", "psMain");
     mpRasterProgram = mpRasterPass->getProgram();
-    mpVars = ProgramVars::create(device, mpRasterProgram->getReflector());
 
-    tringleMesh[0] = TriangleMesh::createSphere();
-    tringleMesh[1] = TriangleMesh::createCube();
-    tringleMesh[2] = TriangleMesh::createFromFile(kCubePath);
-    // Create VAO
-    mpVao[0] = createVao(device, tringleMesh[0]);
-    mpVao[1] = createVao(device, tringleMesh[1]);
-    mpVao[2] = createVao(device, tringleMesh[2]);
+    mpMeshCache = MeshCache::get(device);
+    // The skybox reads positions only.
+    mMeshes[2] = mpMeshCache->getMesh(kCubePath.string(), MeshVertexLayout::TangentSpace);
+    loadMeshes();
 
     // Create FBO
     float height = getConfig().windowDesc.height;
@@ -264,6 +181,8 @@ void PBR::onGuiRender(Gui* pGui)
     w.rgbColor("albedo", albedo);
     w.slider("metallic", metallic, .0f, 1.0f);
     w.slider("roughness", roughness, .0f, 1.0f);
+    if (w.checkbox("Compressed vertices", mCompressedVertices))
+        loadMeshes();
     if (w.button("Load Image"))
     {
         std::filesystem::path filename;
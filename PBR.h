@@ -4,20 +4,12 @@
 #include "Core/Pass/RasterPass.h"
 #include "Core/Program/Program.h"
 #include "Core/Pass/FullScreenPass.h"
-#include <Scene/TriangleMesh.h>
+#include "MeshCache.h"
 
 using namespace Falcor;
 
 class PBR : public SampleApp
 {
-    struct VertexInput
-    {
-        float3 position; ///< Position.
-        float3 normal;   ///< Shading normal.
-        float3 tangent; ///< Shading tangent. The bitangent is computed: cross(normal, tangent.xyz) * tangent.w. NOTE: The tangent is *only*
-        float3 bitangent;
-        float2 texCrd; ///< Texture coordinates.
-    };
     /// <summary>
     /// use float4 for hlsl buffer padding
     /// </summary>
@@ -45,20 +37,16 @@ private:
     const std::string kViewProjMatrices = "viewProjMatrices";
     const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
     const std::string kWorldMatrices = "worldMatrices";
-    static ref<Vao> createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh);
     void postProcess(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo, const ref<Texture>& rt);
     void rasterize(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
+    void loadMeshes();
+    void drawMesh(RenderContext* pRenderContext, const ShaderVar& var, const MeshCache::Mesh& mesh);
     void drawSkybox(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
-    static void generateTangent(
-        const TriangleMesh::VertexList& vertexList,
-        const TriangleMesh::IndexList& indicesList,
-        std::vector<float3>& tangents,
-        std::vector<float3>& bitangents
-    );
-    ref<TriangleMesh> tringleMesh[3];
     ref<RasterPass> mpRasterPass;
     ref<Program> mpRasterProgram;
-    ref<Vao> mpVao[3];
+    MeshCache::Mesh mMeshes[3];
+    std::shared_ptr<MeshCache> mpMeshCache;
+    bool mCompressedVertices = true;
     ref<Fbo> mpRasterFbo;
     ref<ProgramVars> mpVars;
     ref<DepthStencilState> mpDepthStencil;
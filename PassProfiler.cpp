@@ -0,0 +1,179 @@
+#include "PassProfiler.h"
+#include <fstream>
+
+void PassProfiler::beginFrame()
+{
+    FALCOR_ASSERT(mStack.empty());
+    mFrame++;
+
+    // Frame numbers start at 1, so a zero entry in timerFrame means the timer was never used.
+    if (mFrame <= kGpuLatency)
+        return;
+
+    uint64_t readFrame = mFrame - kGpuLatency;
+    uint32_t slot = readFrame % (kGpuLatency + 1);
+    for (auto& pass : mPasses)
+    {
+        if (pass.timerFrame[slot] == readFrame)
+            pass.gpuHistory[readFrame % kHistorySize] = pass.pGpuTimers[slot]->getElapsedTime();
+    }
+}
+
+void PassProfiler::beginPass(const std::string& name)
+{
+    std::string path = mStack.empty() ? name : mPasses[mStack.back()].path + "/" + name;
+
+    auto it = mPassIndex.find(path);
+    size_t index;
+    if (it == mPassIndex.end())
+    {
+        index = mPasses.size();
+        mPassIndex[path] = index;
+        Pass& pass = mPasses.emplace_back();
+        pass.path = path;
+        pass.name = name;
+        pass.depth = (uint32_t)mStack.size();
+        for (auto& pTimer : pass.pGpuTimers)
+            pTimer = GpuTimer::create(mpDevice);
+    }
+    else
+    {
+        index = it->second;
+    }
+    mStack.push_back(index);
+
+    Pass& pass = mPasses[index];
+    uint32_t slot = mFrame % (kGpuLatency + 1);
+    if (pass.lastFrame != mFrame)
+    {
+        pass.lastFrame = mFrame;
+        pass.cpuHistory[mFrame % kHistorySize] = 0.0;
+        pass.gpuHistory[mFrame % kHistorySize] = 0.0;
+        pass.historyFrame[mFrame % kHistorySize] = mFrame;
+
+        // A GPU timer can only be started once per frame. Passes executed repeatedly within one frame
+        // accumulate their CPU time, but only the first execution is timed on the GPU.
+        pass.pGpuTimers[slot]->begin();
+        pass.timerFrame[slot] = mFrame;
+        pass.gpuActive = true;
+    }
+    pass.cpuStart = CpuTimer::getCurrentTimePoint();
+}
+
+void PassProfiler::endPass()
+{
+    FALCOR_ASSERT(!mStack.empty());
+    Pass& pass = mPasses[mStack.back()];
+    mStack.pop_back();
+
+    pass.cpuHistory[mFrame % kHistorySize] += CpuTimer::calcDuration(pass.cpuStart, CpuTimer::getCurrentTimePoint());
+    if (pass.gpuActive)
+    {
+        auto& pTimer = pass.pGpuTimers[mFrame % (kGpuLatency + 1)];
+        pTimer->end();
+        pTimer->resolve();
+        pass.gpuActive = false;
+    }
+}
+
+PassProfiler::Stats PassProfiler::computeStats(const Pass& pass) const
+{
+    Stats stats;
+    // Only frames whose GPU times have been read back are complete.
+    if (mFrame <= kGpuLatency)
+        return stats;
+    uint64_t lastComplete = mFrame - kGpuLatency;
+    uint64_t frameCount = std::min<uint64_t>(lastComplete, kHistorySize - kGpuLatency);
+
+    uint32_t sampleCount = 0;
+    stats.cpuMin = stats.gpuMin = std::numeric_limits<double>::max();
+    for (uint64_t i = 0; i < frameCount; i++)
+    {
+        uint64_t frame = lastComplete - i;
+        // Skip frames in which the pass did not run, e.g. while an effect was disabled.
+        if (pass.historyFrame[frame % kHistorySize] != frame)
+            continue;
+        double cpu = pass.cpuHistory[frame % kHistorySize];
+        double gpu = pass.gpuHistory[frame % kHistorySize];
+        stats.cpuAvg += cpu;
+        stats.gpuAvg += gpu;
+        stats.cpuMin = std::min(stats.cpuMin, cpu);
+        stats.gpuMin = std::min(stats.gpuMin, gpu);
+        stats.cpuMax = std::max(stats.cpuMax, cpu);
+        stats.gpuMax = std::max(stats.gpuMax, gpu);
+        sampleCount++;
+    }
+    if (sampleCount == 0)
+        return Stats();
+
+    stats.cpuAvg /= sampleCount;
+    stats.gpuAvg /= sampleCount;
+    return stats;
+}
+
+PassProfiler::Stats PassProfiler::getStats(const std::string& path) const
+{
+    auto it = mPassIndex.find(path);
+    return it == mPassIndex.end() ? Stats() : computeStats(mPasses[it->second]);
+}
+
+double PassProfiler::getFrameGpuTime() const
+{
+    double total = 0.0;
+    for (const auto& pass : mPasses)
+    {
+        if (pass.depth == 0)
+            total += computeStats(pass).gpuAvg;
+    }
+    return total;
+}
+
+void PassProfiler::dump(const std::filesystem::path& path) const
+{
+    std::ofstream os(path);
+    if (!os)
+        FALCOR_THROW("Failed to open pass timing dump '{}' for writing.", path.string());
+
+    os << "frame,pass,cpuMs,gpuMs\n";
+    if (mFrame <= kGpuLatency)
+        return;
+    uint64_t lastComplete = mFrame - kGpuLatency;
+    uint64_t firstFrame = lastComplete > kHistorySize - kGpuLatency ? lastComplete - (kHistorySize - kGpuLatency) + 1 : 1;
+    for (uint64_t frame = firstFrame; frame <= lastComplete; frame++)
+    {
+        for (const auto& pass : mPasses)
+        {
+            if (pass.historyFrame[frame % kHistorySize] != frame)
+                continue;
+            os << frame << "," << pass.path << "," << pass.cpuHistory[frame % kHistorySize] << "," << pass.gpuHistory[frame % kHistorySize]
+               << "\n";
+        }
+    }
+    logInfo("Pass timings of the last {} frames written to '{}'.", lastComplete - firstFrame + 1, path.string());
+}
+
+void PassProfiler::renderUI(Gui::Widgets& widget)
+{
+    double frameGpu = getFrameGpuTime();
+    widget.var("Budget (ms)", mBudgetMs, 1.0f, 100.0f, 0.1f);
+    widget.text(fmt::format("GPU total {:.3f} ms ({:.0f}% of budget)", frameGpu, 100.0 * frameGpu / mBudgetMs));
+    widget.text("pass                          cpu avg [min, max]        gpu avg [min, max]");
+    for (const auto& pass : mPasses)
+    {
+        Stats s = computeStats(pass);
+        std::string label = std::string(2 * pass.depth, ' ') + pass.name;
+        widget.text(fmt::format(
+            "{:<28}  {:6.3f} [{:6.3f}, {:6.3f}]  {:6.3f} [{:6.3f}, {:6.3f}]{}",
+            label,
+            s.cpuAvg,
+            s.cpuMin,
+            s.cpuMax,
+            s.gpuAvg,
+            s.gpuMin,
+            s.gpuMax,
+            s.gpuAvg > mBudgetMs ? "  over budget" : ""
+        ));
+    }
+    if (widget.button("Dump timings"))
+        dump("PassTimings.csv");
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Falcor.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/GpuTimer.h"
+
+using namespace Falcor;
+
+/** Hierarchical CPU/GPU timing of individual render passes.
+    Passes are identified by their path in the scope stack (e.g. "SSAO/blur/downsample[1]").
+    Every pass keeps a ring buffer of the last kHistorySize frames, from which rolling averages and
+    min/max are computed, and which can be dumped to a CSV file.
+    GPU times are read back kGpuLatency frames late so that profiling never stalls the queue.
+ */
+class PassProfiler
+{
+public:
+    static const uint32_t kHistorySize = 256;
+    static const uint32_t kGpuLatency = 2;
+
+    struct Stats
+    {
+        double cpuAvg = 0, cpuMin = 0, cpuMax = 0;
+        double gpuAvg = 0, gpuMin = 0, gpuMax = 0;
+    };
+
+    /// Opens a pass scope for the lifetime of the object. A null profiler turns this into a no-op.
+    class Scope
+    {
+    public:
+        Scope(PassProfiler* pProfiler, const std::string& name) : mpProfiler(pProfiler)
+        {
+            if (mpProfiler)
+                mpProfiler->beginPass(name);
+        }
+        ~Scope()
+        {
+            if (mpProfiler)
+                mpProfiler->endPass();
+        }
+
+    private:
+        PassProfiler* mpProfiler;
+    };
+
+    PassProfiler(const ref<Device>& pDevice) : mpDevice(pDevice) {}
+
+    /// Closes the previous frame and collects the GPU times that became available.
+    void beginFrame();
+    void beginPass(const std::string& name);
+    void endPass();
+
+    Stats getStats(const std::string& path) const;
+    /// Sum of the GPU averages of all top-level passes.
+    double getFrameGpuTime() const;
+    void dump(const std::filesystem::path& path) const;
+    void renderUI(Gui::Widgets& widget);
+
+private:
+    struct Pass
+    {
+        std::string path;
+        std::string name;
+        uint32_t depth = 0;
+        ref<GpuTimer> pGpuTimers[kGpuLatency + 1];
+        uint64_t timerFrame[kGpuLatency + 1] = {}; ///< Frame in which each timer was last started, 0 if never.
+        double cpuHistory[kHistorySize] = {};
+        double gpuHistory[kHistorySize] = {};
+        uint64_t historyFrame[kHistorySize] = {}; ///< Frame each history entry belongs to, to skip frames the pass did not run in.
+        uint64_t lastFrame = 0; ///< Last frame the pass was executed in.
+        CpuTimer::TimePoint cpuStart;
+        bool gpuActive = false;
+    };
+
+    Stats computeStats(const Pass& pass) const;
+
+    ref<Device> mpDevice;
+    std::vector<Pass> mPasses; ///< In order of first execution, which keeps children after their parent.
+    std::unordered_map<std::string, size_t> mPassIndex;
+    std::vector<size_t> mStack;
+    uint64_t mFrame = 0;
+
+    float mBudgetMs = 16.6f;
+};
+
+#define PASS_PROFILE_CONCAT_(a, b) a##b
+#define PASS_PROFILE_CONCAT(a, b) PASS_PROFILE_CONCAT_(a, b)
+
+/// Profiles the enclosing scope with both Falcor's profiler and the given PassProfiler.
+#define PASS_PROFILE(pProfiler, pRenderContext, name) \
+    FALCOR_PROFILE(pRenderContext, name);             \
+    PassProfiler::Scope PASS_PROFILE_CONCAT(_passProfilerScope, __LINE__)(pProfiler, name)
@@ -3,27 +3,39 @@
 void FilmGrain::onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext)
 {
     MultiPassPostProcess::onLoad(config, pDevice, pRenderContext);
-    addPass("film", "Samples/SampleAppTemplate/PostFX/FilmGrain.ps.slang");
+    mFilmPass = addOutputPass("film", "Samples/SampleAppTemplate/PostFX/FilmGrain.ps.slang");
+    refreshVars();
 }
-void FilmGrain::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
+
+void FilmGrain::resolveVars()
 {
-    auto lutPass = mpPass["film"];
-    
-    auto var = getRootVar(lutPass.pass);
-    var["gTexture"] = color;
+    auto var = getRootVar(getPass(mFilmPass).pass);
     var["gSampler"] = mpLinearSampler;
-    var["strength"] = strength;
-    var["iGlobalTime"] = time;
-    executePass(lutPass, pRenderContext);
+    mVars.texture = var["gTexture"];
+    mVars.time = var["iGlobalTime"];
+    mVars.strength = var["strength"];
+}
+void FilmGrain::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
+{
+    bindParameters(time, color);
+    executePass(mFilmPass, pRenderContext);
 }
 
-void FilmGrain::onGui(Gui* pGui)
+void FilmGrain::bindParameters(float time, const ref<Texture>& color)
 {
-    Gui::Window w(pGui, "FilmGrain", {300, 400}, {10, 80});
-    w.slider("strength", strength, .0f, 100.0f);
+    refreshVars();
+    mVars.texture = color;
+    mVars.time = time;
+    mVars.strength = strength;
 }
 
-ref<Texture> FilmGrain::getFinalColor()
+void FilmGrain::setUberParameters(const ShaderVar& var, float time)
 {
-    return mpPass["film"].fbo->getColorTexture(0);
+    var["filmGrainStrength"] = strength;
+}
+
+void FilmGrain::onGui(Gui* pGui)
+{
+    Gui::Window w(pGui, "FilmGrain", {300, 400}, {10, 80});
+    w.slider("strength", strength, .0f, 100.0f);
 }
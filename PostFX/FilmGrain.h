@@ -12,9 +12,22 @@ class FilmGrain : public MultiPassPostProcess
             ref<Texture> normalWS,
             ref<Texture> posWS
         ) override;
+        void bindParameters(float time, const ref<Texture>& color) override;
+        void resolveVars() override;
         void onGui(Gui* pGui) override;
-        ref<Texture> getFinalColor() override;
+        std::string getName() const override { return "FilmGrain"; }
+        bool isPointwise() const override { return true; }
+        std::string getUberDefine() const override { return "UBER_FILM_GRAIN"; }
+        void setUberParameters(const ShaderVar& var, float time) override;
 
         float strength = 0.0f;
-};
 
+    private:
+        PassHandle mFilmPass = kInvalidPass;
+        struct
+        {
+            ShaderVar texture;
+            ShaderVar time;
+            ShaderVar strength;
+        } mVars;
+};
@@ -1,29 +1,52 @@
 #include "Glitch.h"
 
+namespace
+{
+// GROUP_SIZE in Glitch.cs.slang.
+const uint32_t kGlitchRowThreads = 256;
+}
+
 void Glitch::onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext)
 {
     MultiPassPostProcess::onLoad(config, pDevice, pRenderContext);
-    addPass("glitch", "Samples/SampleAppTemplate/PostFX/Glitch.ps.slang");
+    mGlitchPass = addOutputPass("glitch", "Samples/SampleAppTemplate/PostFX/Glitch.ps.slang");
+    // Every pixel smears a segment of one input row, the compute variant caches that row once per group.
+    mGlitchCSPass = addComputeOutputPass("glitchCS", "Samples/SampleAppTemplate/PostFX/Glitch.cs.slang", kGlitchRowThreads);
+    refreshVars();
 }
-void Glitch::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
+
+void Glitch::resolveVars()
+{
+    mVars = resolvePassVars(getRootVar(getPass(mGlitchPass).pass));
+    auto computeVar = getPass(mGlitchCSPass).computePass->getRootVar()["PerFrameCB"];
+    mComputeVars = resolvePassVars(computeVar);
+    mComputeResolutionVar = computeVar["gResolution"];
+}
+
+Glitch::Vars Glitch::resolvePassVars(const ShaderVar& var)
 {
-    auto lutPass = mpPass["glitch"];
-    
-    auto var = getRootVar(lutPass.pass);
-    var["gTexture"] = color;
     var["gSampler"] = mpLinearSampler;
-    var["strength"] = strength;
-    var["iGlobalTime"] = time;
-    executePass(lutPass, pRenderContext);
+    return {var["gTexture"], var["iGlobalTime"], var["strength"]};
+}
+void Glitch::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
+{
+    bindParameters(time, color);
+    executePass(getOutputPass(), pRenderContext);
 }
 
-void Glitch::onGui(Gui* pGui)
+void Glitch::bindParameters(float time, const ref<Texture>& color)
 {
-    Gui::Window w(pGui, "Glitch", {300, 400}, {10, 80});
-    w.slider("strength", strength, .0f, 1.0f);
+    refreshVars();
+    Vars& vars = isComputeActive() ? mComputeVars : mVars;
+    vars.texture = color;
+    vars.time = time;
+    vars.strength = strength;
+    if (isComputeActive())
+        mComputeResolutionVar = uint2(color->getWidth(), color->getHeight());
 }
 
-ref<Texture> Glitch::getFinalColor()
+void Glitch::onGui(Gui* pGui)
 {
-    return mpPass["glitch"].fbo->getColorTexture(0);
+    Gui::Window w(pGui, "Glitch", {300, 400}, {10, 80});
+    w.slider("strength", strength, .0f, 1.0f);
 }
@@ -12,9 +12,25 @@ class Glitch : public MultiPassPostProcess
             ref<Texture> normalWS,
             ref<Texture> posWS
         ) override;
+        void bindParameters(float time, const ref<Texture>& color) override;
+        void resolveVars() override;
         void onGui(Gui* pGui) override;
-        ref<Texture> getFinalColor() override;
+        std::string getName() const override { return "Glitch"; }
 
         float strength = 0.0f;
-};
 
+    private:
+        struct Vars
+        {
+            ShaderVar texture;
+            ShaderVar time;
+            ShaderVar strength;
+        };
+        Vars resolvePassVars(const ShaderVar& var);
+
+        PassHandle mGlitchPass = kInvalidPass;
+        PassHandle mGlitchCSPass = kInvalidPass;
+        Vars mVars;
+        Vars mComputeVars;
+        ShaderVar mComputeResolutionVar;
+};
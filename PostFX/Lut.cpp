@@ -1,40 +1,121 @@
 #include "Lut.h"
 
+namespace
+{
+const Gui::DropdownList kBakeSizeDropdown = {{32, "32^3"}, {64, "64^3"}};
+} // namespace
+
 void Lut::onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext)
 {
     MultiPassPostProcess::onLoad(config, pDevice, pRenderContext);
-    addPass("lut", "Samples/SampleAppTemplate/PostFX/Lut.ps.slang");
-    lutTex = Texture::createFromFile(device,getRuntimeDirectory() / "data/LUT/Warm Purple.png",false,false);
+    mLutPass = addOutputPass("lut", "Samples/SampleAppTemplate/PostFX/Lut.ps.slang");
+
+    // Clamp addressing keeps the fetch inside the volume, the texel centers already cover the color range.
+    Sampler::Desc samplerDesc;
+    samplerDesc.setFilterMode(TextureFilteringMode::Linear, TextureFilteringMode::Linear, TextureFilteringMode::Point)
+        .setAddressingMode(TextureAddressingMode::Clamp, TextureAddressingMode::Clamp, TextureAddressingMode::Clamp);
+    mpLutSampler = device->createSampler(samplerDesc);
+    refreshVars();
+
+    // Grade with the identity until the default LUT is baked.
+    setLutTexture(LutBaker::createTexture(device, LutBaker::createIdentity(2)));
+    loadLut(getRuntimeDirectory() / "data/LUT/Warm Purple.png");
+}
+
+void Lut::resolveVars()
+{
+    auto var = getRootVar(getPass(mLutPass).pass);
+    var["gSampler"] = mpLinearSampler;
+    var["gLutSampler"] = mpLutSampler;
+    mVars.texture = var["gTexture"];
+    mVars.lut = var["gLut"];
+    mVars.lutSize = var["lutSize"];
+    mVars.amount = var["amount"];
+    if (lutTex)
+        setLutTexture(lutTex);
+}
+
+void Lut::loadLut(const std::filesystem::path& path)
+{
+    mLutPath = path;
+    mPendingBakes.push_back(
+        {++mBakeGeneration, std::async(std::launch::async, [path, size = mBakeSize]() { return LutBaker::bake(path, size); })}
+    );
+}
+
+void Lut::pollPendingLut()
+{
+    for (auto it = mPendingBakes.begin(); it != mPendingBakes.end();)
+    {
+        if (it->lut.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        if (it->generation == mBakeGeneration)
+        {
+            try
+            {
+                setLutTexture(LutBaker::createTexture(device, it->lut.get()));
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to load LUT '{}': {}", mLutPath.string(), e.what());
+            }
+        }
+        it = mPendingBakes.erase(it);
+    }
 }
+
+bool Lut::isBaking() const
+{
+    return !mPendingBakes.empty() && mPendingBakes.back().generation == mBakeGeneration;
+}
+
+void Lut::setLutTexture(const ref<Texture>& pTexture)
+{
+    lutTex = pTexture;
+    mVars.lut = lutTex;
+    mVars.lutSize = (float)lutTex->getWidth();
+}
+
 void Lut::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
 {
-    auto lutPass = mpPass["lut"];
-    
-    auto var = getRootVar(lutPass.pass);
-    var["gTexture"] = color;
+    bindParameters(time, color);
+    executePass(mLutPass, pRenderContext);
+}
+
+void Lut::bindParameters(float time, const ref<Texture>& color)
+{
+    refreshVars();
+    pollPendingLut();
+    mVars.texture = color;
+    mVars.amount = amount;
+}
+
+void Lut::setUberParameters(const ShaderVar& var, float time)
+{
+    pollPendingLut();
     var["gLut"] = lutTex;
-    var["gSampler"] = mpLinearSampler;
-    var["amount"] = amount;
-    executePass(lutPass, pRenderContext);
+    var["gLutSampler"] = mpLutSampler;
+    var["lutSize"] = (float)lutTex->getWidth();
+    var["lutAmount"] = amount;
 }
 
 void Lut::onGui(Gui* pGui)
 {
     Gui::Window w(pGui, "Lut", {300, 400}, {10, 80});
     w.slider("amount", amount, .0f, 1.0f);
+    if (w.dropdown("Bake size", kBakeSizeDropdown, mBakeSize) && !mLutPath.empty())
+        loadLut(mLutPath);
 
-    if (w.button("Load LUT Texture"))
+    if (w.button("Load LUT"))
     {
         std::filesystem::path filename;
-        FileDialogFilterVec filters = {{"bmp"}, {"jpg"}, {"dds"}, {"png"}, {"tiff"}, {"tif"}, {"tga"}};
+        FileDialogFilterVec filters = {{"cube"}, {"bmp"}, {"jpg"}, {"dds"}, {"png"}, {"tiff"}, {"tif"}, {"tga"}};
         if (openFileDialog(filters, filename))
-        {
-            lutTex = Texture::createFromFile(device, filename, false, false);
-        }
+            loadLut(filename);
     }
-}
-
-ref<Texture> Lut::getFinalColor()
-{
-    return mpPass["lut"].fbo->getColorTexture(0);
+    if (isBaking())
+        w.text("Baking " + mLutPath.filename().string() + "...");
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "../MultiPassPostProcess.h"
+#include "LutBaker.h"
+#include <future>
 class Lut : public MultiPassPostProcess
 {
     public:
@@ -12,10 +14,47 @@ class Lut : public MultiPassPostProcess
             ref<Texture> normalWS,
             ref<Texture> posWS
         ) override;
+        void bindParameters(float time, const ref<Texture>& color) override;
+        void resolveVars() override;
         void onGui(Gui* pGui) override;
-        ref<Texture> getFinalColor() override;
+        std::string getName() const override { return "Lut"; }
+        bool isPointwise() const override { return true; }
+        std::string getUberDefine() const override { return "UBER_LUT"; }
+        void setUberParameters(const ShaderVar& var, float time) override;
+        /// Bakes the LUT at `path` on a worker thread. The current LUT stays bound until the new one is ready.
+        /// Bakes still running from earlier calls are abandoned, their results are dropped when they arrive.
+        void loadLut(const std::filesystem::path& path);
         ref<Texture> lutTex;
 
         float amount = 0.0f;
-};
 
+    private:
+        /// Uploads the LUT of the latest loadLut() once its worker has finished and releases finished stale bakes.
+        /// Never blocks.
+        void pollPendingLut();
+        void setLutTexture(const ref<Texture>& pTexture);
+        /// Whether the bake of the latest loadLut() is still running.
+        bool isBaking() const;
+
+        PassHandle mLutPass = kInvalidPass;
+        ref<Sampler> mpLutSampler;
+        std::filesystem::path mLutPath;
+        uint32_t mBakeSize = 32;
+        struct PendingBake
+        {
+            uint32_t generation;
+            std::future<LutBaker::Lut3D> lut;
+        };
+        /// Bakes that have not been collected yet. The destructor of an std::async future waits for its thread, so
+        /// stale bakes are kept here until they finish rather than being dropped on the render thread.
+        std::vector<PendingBake> mPendingBakes;
+        /// Generation of the latest loadLut(), only its bake is uploaded.
+        uint32_t mBakeGeneration = 0;
+        struct
+        {
+            ShaderVar texture;
+            ShaderVar lut;
+            ShaderVar lutSize;
+            ShaderVar amount;
+        } mVars;
+};
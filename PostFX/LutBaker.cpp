@@ -0,0 +1,264 @@
+#include "LutBaker.h"
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+const uint32_t kCacheMagic = 0x4433544c; // "LT3D"
+const uint32_t kCacheVersion = 1;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+};
+
+float4 lerp4(const float4& a, const float4& b, float t)
+{
+    return a + (b - a) * t;
+}
+} // namespace
+
+LutBaker::Lut3D LutBaker::bake(const std::filesystem::path& path, uint32_t size)
+{
+    std::filesystem::path cachePath = getCachePath(path, size);
+    Lut3D lut;
+    if (readCache(cachePath, size, lut))
+    {
+        logInfo("Loaded baked LUT '{}' from '{}'.", path.string(), cachePath.string());
+        return lut;
+    }
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    Lut3D source = path.extension() == ".cube" ? loadCube(path) : loadStrip(path);
+    lut = resample(source, size);
+    float error = validate(source, lut);
+    logInfo(
+        "Baked LUT '{}' ({}^3) to {}^3 in {:.1f} ms, max deviation from the source {:.5f}.",
+        path.string(),
+        source.size,
+        size,
+        CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()),
+        error
+    );
+
+    try
+    {
+        writeCache(cachePath, lut);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to cache baked LUT: {}", e.what());
+    }
+    return lut;
+}
+
+LutBaker::Lut3D LutBaker::createIdentity(uint32_t size)
+{
+    Lut3D lut;
+    lut.size = size;
+    lut.texels.resize(size * size * size);
+    float scale = 1.0f / (size - 1);
+    for (uint32_t b = 0; b < size; b++)
+        for (uint32_t g = 0; g < size; g++)
+            for (uint32_t r = 0; r < size; r++)
+                lut.at(r, g, b) = float4(r * scale, g * scale, b * scale, 1.0f);
+    return lut;
+}
+
+ref<Texture> LutBaker::createTexture(const ref<Device>& pDevice, const Lut3D& lut)
+{
+    return pDevice->createTexture3D(
+        lut.size, lut.size, lut.size, ResourceFormat::RGBA32Float, 1, lut.texels.data(), ResourceBindFlags::ShaderResource
+    );
+}
+
+float3 LutBaker::sampleReference(const Lut3D& lut, float3 color)
+{
+    // Same as a trilinear fetch at color * (size - 1) / size + 0.5 / size with clamp addressing.
+    float3 p = clamp(color, float3(0.0f), float3(1.0f)) * float(lut.size - 1);
+    uint32_t r0 = std::min((uint32_t)p.x, lut.size - 2);
+    uint32_t g0 = std::min((uint32_t)p.y, lut.size - 2);
+    uint32_t b0 = std::min((uint32_t)p.z, lut.size - 2);
+    float3 f = p - float3(float(r0), float(g0), float(b0));
+
+    auto sampleSlice = [&](uint32_t b)
+    {
+        float4 low = lerp4(lut.at(r0, g0, b), lut.at(r0 + 1, g0, b), f.x);
+        float4 high = lerp4(lut.at(r0, g0 + 1, b), lut.at(r0 + 1, g0 + 1, b), f.x);
+        return lerp4(low, high, f.y);
+    };
+    float4 result = lerp4(sampleSlice(b0), sampleSlice(b0 + 1), f.z);
+    return float3(result.x, result.y, result.z);
+}
+
+float LutBaker::validate(const Lut3D& source, const Lut3D& baked, uint32_t steps)
+{
+    float maxError = 0.0f;
+    float scale = 1.0f / (steps - 1);
+    for (uint32_t b = 0; b < steps; b++)
+    {
+        for (uint32_t g = 0; g < steps; g++)
+        {
+            for (uint32_t r = 0; r < steps; r++)
+            {
+                float3 color(r * scale, g * scale, b * scale);
+                float3 d = abs(sampleReference(source, color) - sampleReference(baked, color));
+                maxError = std::max({maxError, d.x, d.y, d.z});
+            }
+        }
+    }
+    return maxError;
+}
+
+LutBaker::Lut3D LutBaker::loadStrip(const std::filesystem::path& path)
+{
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true);
+    if (!pBitmap)
+        FALCOR_THROW("Failed to load LUT '{}'.", path.string());
+
+    uint32_t size = pBitmap->getHeight();
+    if (size < 2 || pBitmap->getWidth() != size * size)
+        FALCOR_THROW("LUT '{}' is {}x{}, expected a strip of N blocks of NxN.", path.string(), pBitmap->getWidth(), size);
+
+    bool bgr = false;
+    switch (pBitmap->getFormat())
+    {
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::RGBA8UnormSrgb:
+        break;
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        bgr = true;
+        break;
+    default:
+        FALCOR_THROW("LUT '{}' has unsupported format {}.", path.string(), to_string(pBitmap->getFormat()));
+    }
+
+    // The strip is loaded as linear UNORM, like the former Texture2D LUT.
+    Lut3D lut;
+    lut.size = size;
+    lut.texels.resize(size * size * size);
+    const uint8_t* pData = pBitmap->getData();
+    for (uint32_t g = 0; g < size; g++)
+    {
+        const uint8_t* pRow = pData + g * pBitmap->getRowPitch();
+        for (uint32_t x = 0; x < size * size; x++)
+        {
+            const uint8_t* pTexel = pRow + x * 4;
+            float4 c(pTexel[0] / 255.0f, pTexel[1] / 255.0f, pTexel[2] / 255.0f, 1.0f);
+            if (bgr)
+                std::swap(c.x, c.z);
+            lut.at(x % size, g, x / size) = c;
+        }
+    }
+    return lut;
+}
+
+LutBaker::Lut3D LutBaker::loadCube(const std::filesystem::path& path)
+{
+    std::ifstream is(path);
+    if (!is)
+        FALCOR_THROW("Failed to open LUT '{}'.", path.string());
+
+    Lut3D lut;
+    std::string line;
+    uint32_t lineNumber = 0;
+    size_t count = 0;
+    while (std::getline(is, line))
+    {
+        lineNumber++;
+        std::istringstream ls(line);
+        std::string keyword;
+        if (!(ls >> keyword) || keyword[0] == '#')
+            continue;
+
+        if (keyword == "TITLE")
+            continue;
+        if (keyword == "LUT_3D_SIZE")
+        {
+            ls >> lut.size;
+            if (lut.size < 2 || lut.size > 256)
+                FALCOR_THROW("LUT '{}' line {}: invalid LUT_3D_SIZE.", path.string(), lineNumber);
+            lut.texels.resize(lut.size * lut.size * lut.size);
+            continue;
+        }
+        if (keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX")
+        {
+            float3 v;
+            ls >> v.x >> v.y >> v.z;
+            if (any(v != float3(keyword == "DOMAIN_MIN" ? 0.0f : 1.0f)))
+                FALCOR_THROW("LUT '{}' line {}: only the [0, 1] domain is supported.", path.string(), lineNumber);
+            continue;
+        }
+        if (keyword == "LUT_1D_SIZE")
+            FALCOR_THROW("LUT '{}' is a 1D LUT, only 3D LUTs are supported.", path.string());
+
+        float4 c(0.0f, 0.0f, 0.0f, 1.0f);
+        std::istringstream data(line);
+        if (!(data >> c.x >> c.y >> c.z))
+            FALCOR_THROW("LUT '{}' line {}: unknown keyword '{}'.", path.string(), lineNumber, keyword);
+        if (count >= lut.texels.size())
+            FALCOR_THROW("LUT '{}' line {}: more entries than LUT_3D_SIZE^3.", path.string(), lineNumber);
+        lut.texels[count++] = c; // Red varies fastest, as in Lut3D.
+    }
+    if (lut.size == 0 || count != lut.texels.size())
+        FALCOR_THROW("LUT '{}' has {} entries, expected LUT_3D_SIZE^3.", path.string(), count);
+    return lut;
+}
+
+LutBaker::Lut3D LutBaker::resample(const Lut3D& source, uint32_t size)
+{
+    if (source.size == size)
+        return source;
+
+    Lut3D lut;
+    lut.size = size;
+    lut.texels.resize(size * size * size);
+    float scale = 1.0f / (size - 1);
+    for (uint32_t b = 0; b < size; b++)
+        for (uint32_t g = 0; g < size; g++)
+            for (uint32_t r = 0; r < size; r++)
+                lut.at(r, g, b) = float4(sampleReference(source, float3(r * scale, g * scale, b * scale)), 1.0f);
+    return lut;
+}
+
+std::filesystem::path LutBaker::getCachePath(const std::filesystem::path& path, uint32_t size)
+{
+    std::error_code ec;
+    std::string key = std::filesystem::absolute(path, ec).string();
+    key += fmt::format("|{}|{}", std::filesystem::file_size(path, ec), size);
+    key += fmt::format("|{}", std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    return getRuntimeDirectory() / "cache" / "lut" / fmt::format("{:016x}.lut3d", std::hash<std::string>()(key));
+}
+
+bool LutBaker::readCache(const std::filesystem::path& cachePath, uint32_t size, Lut3D& lut)
+{
+    std::ifstream is(cachePath, std::ios::binary);
+    if (!is)
+        return false;
+
+    CacheHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kCacheMagic || header.version != kCacheVersion ||
+        header.size != size)
+        return false;
+
+    lut.size = size;
+    lut.texels.resize(size * size * size);
+    return (bool)is.read(reinterpret_cast<char*>(lut.texels.data()), lut.texels.size() * sizeof(float4));
+}
+
+void LutBaker::writeCache(const std::filesystem::path& cachePath, const Lut3D& lut)
+{
+    std::filesystem::create_directories(cachePath.parent_path());
+    std::ofstream os(cachePath, std::ios::binary);
+    if (!os)
+        FALCOR_THROW("Failed to open LUT cache '{}' for writing.", cachePath.string());
+
+    CacheHeader header{kCacheMagic, kCacheVersion, lut.size};
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(lut.texels.data()), lut.texels.size() * sizeof(float4));
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** Converts color grading LUTs into 3D textures.
+    Sources are 2D strip LUTs (N blocks of NxN side by side, blue selects the block, e.g. 1024x32) and
+    Adobe .cube files. Both are resampled to a size^3 RGBA32Float volume, so that the shader does a single
+    hardware trilinear fetch. Baked volumes are cached on disk, keyed by source path, size, modification
+    time and target size.
+    Everything except createTexture() only touches CPU data and can run on a worker thread.
+ */
+class LutBaker
+{
+public:
+    struct Lut3D
+    {
+        uint32_t size = 0;
+        /// size^3 texels, red varies fastest.
+        std::vector<float4> texels;
+
+        float4& at(uint32_t r, uint32_t g, uint32_t b) { return texels[(b * size + g) * size + r]; }
+        const float4& at(uint32_t r, uint32_t g, uint32_t b) const { return texels[(b * size + g) * size + r]; }
+    };
+
+    /// Loads `path` (.cube or any image format Bitmap reads), going through the disk cache.
+    static Lut3D bake(const std::filesystem::path& path, uint32_t size);
+    /// Identity LUT of the given size. Trilinear filtering makes size 2 exact.
+    static Lut3D createIdentity(uint32_t size);
+    static ref<Texture> createTexture(const ref<Device>& pDevice, const Lut3D& lut);
+
+    /// CPU references of the shader lookups, for validating that the baked volume grades like its source.
+    static float3 sampleReference(const Lut3D& lut, float3 color);
+    /// Returns the largest per-channel difference between the volume and its source over a grid of colors.
+    static float validate(const Lut3D& source, const Lut3D& baked, uint32_t steps = 33);
+
+private:
+    static Lut3D loadStrip(const std::filesystem::path& path);
+    static Lut3D loadCube(const std::filesystem::path& path);
+    static Lut3D resample(const Lut3D& source, uint32_t size);
+    static std::filesystem::path getCachePath(const std::filesystem::path& path, uint32_t size);
+    static bool readCache(const std::filesystem::path& cachePath, uint32_t size, Lut3D& lut);
+    static void writeCache(const std::filesystem::path& cachePath, const Lut3D& lut);
+};
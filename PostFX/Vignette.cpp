@@ -0,0 +1,66 @@
+#include "Vignette.h"
+
+void Vignette::onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext)
+{
+    MultiPassPostProcess::onLoad(config, pDevice, pRenderContext);
+    mVignettePass = addOutputPass("vignette", "Samples/SampleAppTemplate/PostFX/Vignette.ps.slang");
+    refreshVars();
+}
+
+void Vignette::resolveVars()
+{
+    const ref<FullScreenPass>& pass = getPass(mVignettePass).pass;
+    auto var = getRootVar(pass);
+    var["gSampler"] = mpLinearSampler;
+    mVars.texture = var["gTexture"];
+    auto params = pass->getRootVar()["VignetteCB"]["gVignette"];
+    mVars.screenParams = params["screenParams"];
+    mVars.center = params["center"];
+    mVars.settings = params["settings"];
+    mVars.color = params["color"];
+}
+void Vignette::onFrameRender(RenderContext* pRenderContext, float time, ref<Texture> color, ref<Texture> depth, ref<Texture> normalWS,ref<Texture>posWS)
+{
+    bindParameters(time, color);
+    executePass(mVignettePass, pRenderContext);
+}
+
+void Vignette::bindParameters(float time, const ref<Texture>& color)
+{
+    refreshVars();
+    mVars.texture = color;
+    mVars.screenParams = float2(screenWidth, screenHeight);
+    mVars.center = center;
+    mVars.settings = getSettings();
+    mVars.color = this->color;
+}
+
+void Vignette::setUberParameters(const ShaderVar& var, float time)
+{
+    setVignetteParams(var["gVignette"]);
+}
+
+void Vignette::setVignetteParams(const ShaderVar& var)
+{
+    var["screenParams"] = float2(screenWidth, screenHeight);
+    var["center"] = center;
+    var["settings"] = getSettings();
+    var["color"] = color;
+}
+
+float4 Vignette::getSettings() const
+{
+    // Same packing as Unity's post-processing stack, which the shader was ported from.
+    return float4(intensity * 3.0f, smoothness * 5.0f, roundness, rounded ? 1.0f : 0.0f);
+}
+
+void Vignette::onGui(Gui* pGui)
+{
+    Gui::Window w(pGui, "Vignette", {300, 400}, {10, 80});
+    w.slider("intensity", intensity, .0f, 1.0f);
+    w.slider("smoothness", smoothness, 0.01f, 1.0f);
+    w.slider("roundness", roundness, 0.01f, 1.0f);
+    w.checkbox("rounded", rounded);
+    w.var("center", center, 0.0f, 1.0f, 0.01f);
+    w.rgbColor("color", color);
+}
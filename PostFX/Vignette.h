@@ -0,0 +1,43 @@
+#pragma once
+#include "../MultiPassPostProcess.h"
+class Vignette : public MultiPassPostProcess
+{
+    public:
+        void onLoad(const SampleAppConfig& config, const ref<Device>& pDevice, RenderContext* pRenderContext)override;
+        void onFrameRender(
+            RenderContext* pRenderContext,
+            float time,
+            ref<Texture> color,
+            ref<Texture> depth,
+            ref<Texture> normalWS,
+            ref<Texture> posWS
+        ) override;
+        void bindParameters(float time, const ref<Texture>& color) override;
+        void resolveVars() override;
+        void onGui(Gui* pGui) override;
+        std::string getName() const override { return "Vignette"; }
+        bool isPointwise() const override { return true; }
+        std::string getUberDefine() const override { return "UBER_VIGNETTE"; }
+        void setUberParameters(const ShaderVar& var, float time) override;
+
+        float intensity = 0.0f;
+        float smoothness = 0.2f;
+        float roundness = 1.0f;
+        bool rounded = false;
+        float2 center = float2(0.5f, 0.5f);
+        float3 color = float3(0.0f);
+
+    private:
+        void setVignetteParams(const ShaderVar& var);
+        float4 getSettings() const;
+
+        PassHandle mVignettePass = kInvalidPass;
+        struct
+        {
+            ShaderVar texture;
+            ShaderVar screenParams;
+            ShaderVar center;
+            ShaderVar settings;
+            ShaderVar color;
+        } mVars;
+};
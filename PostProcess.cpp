@@ -1,5 +1,8 @@
 #include "PostProcess.h"
 
+bool PostProcess::sDefaultFusePointwise = true;
+uint32_t PostProcess::sMicrobenchmarkEffectCount = 0;
+
 PostProcess::PostProcess(const SampleAppConfig& config):GBuffer(config) {}
 
 PostProcess::~PostProcess() {}
@@ -7,27 +10,233 @@ PostProcess::~PostProcess() {}
 void PostProcess::onLoad(RenderContext* pRenderContext)
 {
     GBuffer::onLoad(pRenderContext);
+    mpTexturePool = std::make_unique<TransientTexturePool>(getDevice());
+    mpUberPass = FullScreenPass::create(getDevice(), "Samples/SampleAppTemplate/PostFX/UberPost.ps.slang");
+    mpUberFbo = Fbo::create(getDevice());
     for (auto& postPass : pp)
     {
         postPass->onLoad(getConfig(), getDevice(), pRenderContext);
+        postPass->setProfiler(mpPassProfiler.get());
+        // The effects process the G-buffer color, which is at render resolution.
+        postPass->onResize(mpFbo->getWidth(), mpFbo->getHeight());
+    }
+    // The chain keeps its own pool, its intermediate formats depend on the backend of every effect.
+    mpGraph->addNode({
+        "PostFX",
+        {"color", "depth"},
+        {{"color", ResourceFormat::RGBA8UnormSrgb}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        { executeChain(ctx.pRenderContext, res.getInput("color"), res.getInput("depth"), res.getOutput("color")); },
+        [this]() { return std::any_of(pp.begin(), pp.end(), [](const auto& postPass) { return postPass->enabled; }); },
+    });
+
+    if (sMicrobenchmarkEffectCount > 0)
+    {
+        runBindingMicrobenchmark(pRenderContext, sMicrobenchmarkEffectCount);
+        shutdown();
+    }
+}
+
+void PostProcess::runBindingMicrobenchmark(RenderContext* pRenderContext, uint32_t effectCount)
+{
+    const uint32_t kIterations = 10000;
+
+    std::vector<std::shared_ptr<FilmGrain>> chain(effectCount);
+    for (auto& effect : chain)
+    {
+        effect = std::make_shared<FilmGrain>();
+        effect->onLoad(getConfig(), getDevice(), pRenderContext);
+    }
+
+    // The lookups every effect did per frame before pass handles: a map lookup copying the Pass,
+    // then a reflection lookup by name for every parameter.
+    std::map<std::string, MultiPassPostProcess::Pass> legacyPasses;
+    std::vector<std::string> legacyNames(effectCount);
+    for (uint32_t i = 0; i < effectCount; i++)
+    {
+        legacyNames[i] = "film" + std::to_string(i);
+        legacyPasses[legacyNames[i]] = chain[i]->getPass(chain[i]->findPass("film"));
+    }
+
+    auto measure = [&](auto&& bindChain)
+    {
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+            bindChain((float)i);
+        return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) * 1000.0 / kIterations; // us per frame
+    };
+
+    double legacyUs = measure(
+        [&](float time)
+        {
+            for (uint32_t i = 0; i < effectCount; i++)
+            {
+                const auto& effect = chain[i];
+                auto pass = legacyPasses[legacyNames[i]];
+                auto var = effect->getRootVar(pass.pass);
+                var["gTexture"] = mpRTs[0];
+                var["gSampler"] = effect->mpLinearSampler;
+                var["strength"] = effect->strength;
+                var["iGlobalTime"] = time;
+            }
+        }
+    );
+    double cachedUs = measure(
+        [&](float time)
+        {
+            for (const auto& effect : chain)
+                effect->bindParameters(time, mpRTs[0]);
+        }
+    );
+
+    logInfo(
+        "PostFX binding microbenchmark, {} effects, {} frames: name lookups {:.3f} us/frame, cached handles {:.3f} us/frame ({:.1f}x).",
+        effectCount,
+        kIterations,
+        legacyUs,
+        cachedUs,
+        legacyUs / std::max(cachedUs, 1e-9)
+    );
+}
+
+void PostProcess::resizeRenderTargets(uint2 renderDim)
+{
+    GBuffer::resizeRenderTargets(renderDim);
+    // Effects that are not loaded yet have no targets, onLoad() sizes them.
+    for (auto& postPass : pp)
+        postPass->onResize(renderDim.x, renderDim.y);
+}
+
+ref<Texture> PostProcess::acquireTarget(const ref<Texture>& pSrc, const MultiPassPostProcess& effect)
+{
+    return mpTexturePool->acquire(pSrc->getWidth(), pSrc->getHeight(), effect.getOutputFormat(), effect.getOutputBindFlags());
+}
+
+void PostProcess::executeUberPass(RenderContext* pRenderContext, float time, size_t first, size_t last, const ref<Texture>& pSrc, const ref<Texture>& pDst)
+{
+    PASS_PROFILE(mpPassProfiler.get(), pRenderContext, "UberPost");
+
+    DefineList defines;
+    for (const auto& postPass : pp)
+    {
+        if (postPass->isPointwise())
+            defines.add(postPass->getUberDefine(), "0");
+    }
+    for (size_t i = first; i < last; i++)
+    {
+        if (pp[i]->enabled)
+            defines.add(pp[i]->getUberDefine(), "1");
     }
+    updatePassDefines(mpUberPass.get(), defines);
+
+    auto var = mpUberPass->getRootVar()["PerFrameCB"];
+    var["gTexture"] = pSrc;
+    var["gSampler"] = pp[first]->mpLinearSampler;
+    var["iGlobalTime"] = time;
+    for (size_t i = first; i < last; i++)
+    {
+        if (pp[i]->enabled)
+            pp[i]->setUberParameters(var, time);
+    }
+    mpUberFbo->attachColorTarget(pDst, 0);
+    mpUberPass->execute(pRenderContext, mpUberFbo);
 }
-void PostProcess::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
+
+void PostProcess::executeChain(
+    RenderContext* pRenderContext,
+    const ref<Texture>& pInput,
+    const ref<Texture>& pDepth,
+    const ref<Texture>& pOutput
+)
 {
-    GBuffer::onFrameRender(pRenderContext, mpFbo);
+    mpTexturePool->beginFrame();
+    float time = (float)getGlobalClock().getTime();
+    ref<Texture> pColor = pInput;
+    auto advance = [&](const ref<Texture>& pNext)
+    {
+        if (pColor != pInput)
+            mpTexturePool->release(pColor);
+        pColor = pNext;
+    };
 
-    for (size_t i =0;i< pp.size();i++)
+    for (size_t i = 0; i < pp.size();)
     {
-        pp[i]->onFrameRender(
-            pRenderContext, (float)getGlobalClock().getTime(), i == 0 ? mpRTs[0] : pp[i - 1]->getFinalColor(), mpDepthRT, nullptr, nullptr
-        );
+        if (!pp[i]->enabled)
+        {
+            i++;
+            continue;
+        }
+
+        if (mFusePointwise && pp[i]->isPointwise())
+        {
+            // Fuse the run of consecutive pointwise effects, disabled ones in between don't break it.
+            size_t last = i + 1;
+            while (last < pp.size() && (pp[last]->isPointwise() || !pp[last]->enabled))
+                last++;
+            // The uber pass is a raster pass, which the default output format of any effect suits.
+            ref<Texture> pNext = acquireTarget(pColor, *pp[i]);
+            executeUberPass(pRenderContext, time, i, last, pColor, pNext);
+            advance(pNext);
+            i = last;
+            continue;
+        }
+
+        PASS_PROFILE(mpPassProfiler.get(), pRenderContext, pp[i]->getName());
+        ref<Texture> pNext = acquireTarget(pColor, *pp[i]);
+        pp[i]->setOutput(pNext);
+        pp[i]->onFrameRender(pRenderContext, time, pColor, pDepth, nullptr, nullptr);
+        advance(pNext);
+        i++;
     }
-    pRenderContext->blit(pp[pp.size() - 1]->getFinalColor()->getSRV(), pTargetFbo->getRenderTargetView(0));
+    pRenderContext->blit(pColor->getSRV(), pOutput->getRTV());
+    advance(nullptr);
 }
 
 void PostProcess::onGuiRender(Gui* pGui)
 {
     GBuffer::onGuiRender(pGui);
+    {
+        Gui::Window w(pGui, "PostFX", {300, 200});
+        w.checkbox("Fuse pointwise effects", mFusePointwise);
+        for (auto& postPass : pp)
+        {
+            w.checkbox(postPass->getName().c_str(), postPass->enabled);
+            if (postPass->supportsCompute())
+                w.checkbox(("Compute##" + postPass->getName()).c_str(), postPass->useCompute, true);
+        }
+
+        // Estimated color traffic of the chain: every pass reads its input and writes its output target.
+        // Neighborhood taps of Glitch mostly hit the texture cache (or groupshared memory) and are not counted.
+        double pixelCount = (double)mpFbo->getWidth() * mpFbo->getHeight();
+        uint32_t multiPassBytes = 0, fusedBytes = 0;
+        uint32_t inputBytes = getFormatBytesPerBlock(mpRTs[0]->getFormat());
+        uint32_t fusedInputBytes = inputBytes;
+        bool inPointwiseRun = false;
+        for (const auto& postPass : pp)
+        {
+            if (!postPass->enabled)
+                continue;
+            uint32_t outputBytes = getFormatBytesPerBlock(postPass->getOutputFormat());
+            multiPassBytes += inputBytes + outputBytes;
+            inputBytes = outputBytes;
+            if (!postPass->isPointwise() || !inPointwiseRun)
+            {
+                fusedBytes += fusedInputBytes + outputBytes;
+                fusedInputBytes = outputBytes;
+            }
+            inPointwiseRun = postPass->isPointwise();
+        }
+        w.text(fmt::format(
+            "Traffic per frame: multi-pass {:.1f} MB, fused {:.1f} MB",
+            multiPassBytes * pixelCount / (1024.0 * 1024.0),
+            fusedBytes * pixelCount / (1024.0 * 1024.0)
+        ));
+        w.text(fmt::format(
+            "Chain targets: {} textures, {:.1f} MB",
+            mpTexturePool->getTextureCount(),
+            mpTexturePool->getAllocatedBytes() / (1024.0 * 1024.0)
+        ));
+    }
     for (auto& postPass : pp)
     {
         postPass->onGui(pGui);
@@ -6,6 +6,8 @@
 #include "PostFX/Lut.h"
 #include "PostFX/FilmGrain.h"
 #include "PostFX/Glitch.h"
+#include "PostFX/Vignette.h"
+#include "TransientTexturePool.h"
 
 using namespace Falcor;
 
@@ -17,8 +19,34 @@ public:
     std::vector<std::shared_ptr<MultiPassPostProcess>> pp = {
         std::make_shared<Lut>(),
         std::make_shared<FilmGrain>(),
+        std::make_shared<Vignette>(),
         std::make_shared<Glitch>()};
     void onLoad(RenderContext* pRenderContext) override;
-    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
     void onGuiRender(Gui* pGui) override;
+
+    /// Whether newly created samples fuse pointwise effects, settable from the command line.
+    static bool sDefaultFusePointwise;
+    /// If non-zero, onLoad() runs the parameter binding microbenchmark with a chain of this many effects and exits.
+    static uint32_t sMicrobenchmarkEffectCount;
+
+protected:
+    void resizeRenderTargets(uint2 renderDim) override;
+
+private:
+    /// Acquires a chain target of the size of `pSrc` in the output format of `effect`'s active backend.
+    ref<Texture> acquireTarget(const ref<Texture>& pSrc, const MultiPassPostProcess& effect);
+    /// Compares the per-frame CPU cost of binding a chain of effects through cached handles and shader vars
+    /// against the former name based lookups.
+    void runBindingMicrobenchmark(RenderContext* pRenderContext, uint32_t effectCount);
+    /// Runs the enabled effects on `pInput` and copies the result to `pOutput`, as the "PostFX" node.
+    void executeChain(RenderContext* pRenderContext, const ref<Texture>& pInput, const ref<Texture>& pDepth, const ref<Texture>& pOutput);
+    /// Runs the enabled pointwise effects in pp[first, last) as a single UberPost.ps.slang pass.
+    void executeUberPass(RenderContext* pRenderContext, float time, size_t first, size_t last, const ref<Texture>& pSrc, const ref<Texture>& pDst);
+
+    /// Targets of the effect chain. Every effect renders into a pooled texture and releases its input,
+    /// so the chain ping-pongs between two textures.
+    std::unique_ptr<TransientTexturePool> mpTexturePool;
+    ref<FullScreenPass> mpUberPass;
+    ref<Fbo> mpUberFbo;
+    bool mFusePointwise = sDefaultFusePointwise;
 };
@@ -4,9 +4,34 @@
 namespace
 {
 const Gui::DropdownList kDistributionDropdown = {
-    {(uint32_t)SSAO::SampleDistribution::Random, "Random"},
-    {(uint32_t)SSAO::SampleDistribution::UniformHammersley, "Uniform Hammersley"},
-    {(uint32_t)SSAO::SampleDistribution::CosineHammersley, "Cosine Hammersley"}};
+    {(uint32_t)SSAOTechnique::SampleDistribution::Random, "Random"},
+    {(uint32_t)SSAOTechnique::SampleDistribution::UniformHammersley, "Uniform Hammersley"},
+    {(uint32_t)SSAOTechnique::SampleDistribution::CosineHammersley, "Cosine Hammersley"}};
+
+const Gui::DropdownList kResolutionDropdown = {
+    {(uint32_t)SSAOTechnique::AOResolution::Full, "Full"},
+    {(uint32_t)SSAOTechnique::AOResolution::Half, "Half"},
+    {(uint32_t)SSAOTechnique::AOResolution::Quarter, "Quarter"}};
+
+const Gui::DropdownList kBackendDropdown = {
+    {(uint32_t)SSAOTechnique::AOBackend::HemisphereKernel, "Hemisphere Kernel"},
+    {(uint32_t)SSAOTechnique::AOBackend::GTAO, "GTAO"}};
+
+// GTAO reads mip 0 for steps shorter than 2^kGTAOMipOffset pixels.
+const float kGTAOMipOffset = 3.0f;
+// Rays and steps per ray of the brute-force reference.
+const uint32_t kReferenceRayCount = 128;
+const uint32_t kReferenceStepCount = 16;
+
+/// Van der Corput radical inverse of `index`, one dimension of the Halton sequence.
+float radicalInverse(uint32_t index, uint32_t base)
+{
+    float result = 0.0f;
+    float digit = 1.0f / base;
+    for (; index > 0; index /= base, digit /= base)
+        result += (index % base) * digit;
+    return result;
+}
 
 const std::string kAoMapSize = "aoMapSize";
 const std::string kKernelSize = "kernelSize";
@@ -23,38 +48,30 @@ const std::string kNormals = "normals";
 const std::string kAoMap = "AoMap";
 } // namespace
 
-SSAO::SSAO(const SampleAppConfig& config) : GBuffer(config)
-{
-    //
-}
-
-SSAO::~SSAO()
-{
-    //
-}
-void SSAO::setSampleRadius(float radius)
+void SSAOTechnique::setSampleRadius(float radius)
 {
     mData.radius = radius;
     mDirty = true;
 }
 
-void SSAO::setKernelSize(uint32_t kernelSize)
+void SSAOTechnique::setKernelSize(uint32_t kernelSize)
 {
     kernelSize = math::clamp(kernelSize, 1u, SSAOData::kMaxSamples);
     mData.kernelSize = kernelSize;
     setKernel();
 }
 
-void SSAO::setDistribution(uint32_t distribution)
+void SSAOTechnique::setDistribution(uint32_t distribution)
 {
     mHemisphereDistribution = (SampleDistribution)distribution;
     setKernel();
 }
 
-void SSAO::setKernel()
+void SSAOTechnique::setKernel()
 {
     auto nextRandom11 = [&]() -> float { return getRandomFloat() * 2.0f - 1.0f; };
-    for (uint32_t i = 0; i < mData.kernelSize; i++)
+    const uint32_t sequenceSize = getSequenceSize();
+    for (uint32_t i = 0; i < sequenceSize; i++)
     {
         // Hemisphere in the Z+ direction
         float3 p;
@@ -65,18 +82,18 @@ void SSAO::setKernel()
             break;
 
         case SampleDistribution::UniformHammersley:
-            p = hammersleyUniform(i, mData.kernelSize);
+            p = hammersleyUniform(i, sequenceSize);
             break;
 
         case SampleDistribution::CosineHammersley:
-            p = hammersleyCosine(i, mData.kernelSize);
+            p = hammersleyCosine(i, sequenceSize);
             break;
         }
 
         mData.sampleKernel[i] = float4(p, 0.0f);
 
         // Skew sample point distance on a curve so more cluster around the origin
-        float dist = (float)i / (float)mData.kernelSize;
+        float dist = (float)i / (float)sequenceSize;
         dist = math::lerp(0.1f, 1.0f, dist * dist);
         mData.sampleKernel[i] *= dist;
     }
@@ -97,7 +114,7 @@ uint packUnorm4x8(float4 v)
 {
     return (packUnorm8(v.w) << 24) | (packUnorm8(v.z) << 16) | (packUnorm8(v.y) << 8) | packUnorm8(v.x);
 }
-void SSAO::setNoiseTexture(uint32_t width, uint32_t height)
+void SSAOTechnique::setNoiseTexture(uint32_t width, uint32_t height)
 {
     std::vector<uint32_t> data;
     data.resize(width * height);
@@ -109,7 +126,7 @@ void SSAO::setNoiseTexture(uint32_t width, uint32_t height)
         data[i] = packUnorm4x8(float4(dir, 0.0f, 1.0f));
     }
 
-    mpNoiseTexture = getDevice()->createTexture2D(
+    mpNoiseTexture = mpDevice->createTexture2D(
         width,
         height,
         ResourceFormat::RGBA8UnormSrgb,
@@ -119,19 +136,29 @@ void SSAO::setNoiseTexture(uint32_t width, uint32_t height)
         ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
     );
 
-    mData.noiseScale = float2(mpAOFbo->getWidth(), mpAOFbo->getHeight()) / float2(width, height);
+    mpGraph->importTexture("ssaoNoise", mpNoiseTexture);
+    mNoiseSize = uint2(width, height);
 
     mDirty = true;
 }
 
-ref<Texture> SSAO::generateAOMap(
-    RenderContext* pRenderContext,
-    const Camera* pCamera,
+void SSAOTechnique::generateAOMap(
+    const TechniqueGraph::FrameContext& ctx,
     const ref<Texture>& pDepthTexture,
-    const ref<Texture>& pNoiseTexture,
-    const ref<Texture>& pNormalTexture
+    const ref<Texture>& pNormalTexture,
+    const ref<Texture>& pAoMap,
+    const ref<Sampler>& pDepthSampler
 )
 {
+    if (GBuffer::updatePassDefines(mpSSAOPass.get(), ctx.gbufferDefines))
+        mDirty = true;
+    // The noise texture is tiled over the AO map, whatever its resolution.
+    float2 noiseScale = float2(pAoMap->getWidth(), pAoMap->getHeight()) / float2(mNoiseSize);
+    if (any(noiseScale != mData.noiseScale))
+    {
+        mData.noiseScale = noiseScale;
+        mDirty = true;
+    }
     if (mDirty)
     {
         ShaderVar var = mpSSAOPass->getRootVar()["StaticCB"];
@@ -142,201 +169,535 @@ ref<Texture> SSAO::generateAOMap(
 
     {
         ShaderVar var = mpSSAOPass->getRootVar()["PerFrameCB"];
-        pCamera->bindShaderData(var["gCamera"]);
+        ctx.pCamera->bindShaderData(var["gCamera"]);
+        // With temporal accumulation, successive frames take interleaved subsets of the kernel and shift the noise
+        // by a Halton offset, so the history sees the whole kernel under ever different rotations.
+        uint32_t sequenceSize = getSequenceSize();
+        uint32_t stride = std::max(1u, sequenceSize / mData.kernelSize);
+        float2 noiseOffset = float2(0.0f);
+        if (mTemporal)
+        {
+            float2 halton = float2(radicalInverse(ctx.frameIndex, 2), radicalInverse(ctx.frameIndex, 3));
+            noiseOffset = math::floor(halton * float2(mNoiseSize)) / float2(mNoiseSize);
+        }
+        var["gSequenceSize"] = sequenceSize;
+        var["gSampleStride"] = stride;
+        var["gSampleOffset"] = mTemporal ? ctx.frameIndex % stride : 0u;
+        var["gNoiseOffset"] = noiseOffset;
     }
 
     // Update state/vars
     auto rootVar = mpSSAOPass->getRootVar();
 
     rootVar["gNoiseSampler"] = mpNoiseSampler;
-    rootVar["gTextureSampler"] = gSampler;
+    rootVar["gTextureSampler"] = pDepthSampler;
     rootVar["gDepthTex"] = pDepthTexture;
-    rootVar["gNoiseTex"] = pNoiseTexture;
+    rootVar["gNoiseTex"] = mpNoiseTexture;
     rootVar["gNormalTex"] = pNormalTexture;
 
     // Generate AO
-    mpSSAOPass->execute(pRenderContext, mpAOFbo);
-    return mpAOFbo->getColorTexture(0);
+    mpAOFbo->attachColorTarget(pAoMap, 0);
+    mpSSAOPass->execute(ctx.pRenderContext, mpAOFbo);
 }
 
-void SSAO::blurMap(RenderContext* pRenderContext, const ref<Texture>& pSrc, uint32_t downSample)
+void SSAOTechnique::setResolution(AOResolution resolution)
 {
+    mResolution = resolution;
+    float scale = resolution == AOResolution::Quarter ? 0.25f : resolution == AOResolution::Half ? 0.5f : 1.0f;
+    for (const char* name : {"aoDepth", "aoNormal", "aoMapLow"})
+        mpGraph->setOutputScale(name, scale);
+}
+
+void SSAOTechnique::setTemporal(bool temporal)
+{
+    mTemporal = temporal;
+    // The kernel holds the whole sequence the frames cycle through.
+    setKernel();
+}
+
+void SSAOTechnique::accumulateAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+{
+    const ref<Texture>& pAoMap = res.getOutput("aoMap");
+    const uint2 dim = uint2(pAoMap->getWidth(), pAoMap->getHeight());
+    bool resetHistory = ctx.frameIndex != mLastAccumulatedFrame + 1;
+    if (!mpAOHistory[0] || mpAOHistory[0]->getWidth() != dim.x || mpAOHistory[0]->getHeight() != dim.y)
+    {
+        for (auto& pHistory : mpAOHistory)
+        {
+            pHistory = mpDevice->createTexture2D(
+                dim.x, dim.y, ResourceFormat::RGBA16Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+            );
+        }
+        resetHistory = true;
+    }
+
+    GBuffer::updatePassDefines(mpTemporalPass.get(), ctx.gbufferDefines);
+    auto var = mpTemporalPass->getRootVar();
+    ctx.pCamera->bindShaderData(var["PerFrameCB"]["gCamera"]);
+    var["PerFrameCB"]["gDim"] = dim;
+    var["PerFrameCB"]["gMaxHistory"] = mMaxHistory;
+    var["PerFrameCB"]["gDepthTolerance"] = mHistoryDepthTolerance;
+    var["PerFrameCB"]["gResetHistory"] = resetHistory ? 1u : 0u;
+    var["gLinearSampler"] = ctx.pSampler;
+    var["gAO"] = res.getInput("aoMap");
+    var["gMotion"] = res.getInput("mvec");
+    var["gDepth"] = res.getInput("depth");
+    var["gHistory"] = mpAOHistory[mHistoryIndex];
+    var["gHistoryOut"] = mpAOHistory[mHistoryIndex ^ 1];
+    var["gAOOut"] = pAoMap;
+    mpTemporalPass->execute(ctx.pRenderContext, uint3(dim, 1));
+
+    mHistoryIndex ^= 1;
+    mLastAccumulatedFrame = ctx.frameIndex;
+}
+
+void SSAOTechnique::downsampleAOInputs(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+{
+    const ref<Texture>& pDepth = res.getInput("depth");
+    const ref<Texture>& pLowDepth = res.getOutput("aoDepth");
+    GBuffer::updatePassDefines(mpDownsampleInputsPass.get(), ctx.gbufferDefines);
+    auto var = mpDownsampleInputsPass->getRootVar();
+    var["PerFrameCB"]["gFullResDim"] = uint2(pDepth->getWidth(), pDepth->getHeight());
+    var["PerFrameCB"]["gLowResDim"] = uint2(pLowDepth->getWidth(), pLowDepth->getHeight());
+    var["PerFrameCB"]["gFactor"] = (pDepth->getWidth() + pLowDepth->getWidth() - 1) / pLowDepth->getWidth();
+    var["gDepth"] = pDepth;
+    var["gNormal"] = res.getInput("normW");
+    var["gLowDepthOut"] = pLowDepth;
+    var["gLowNormalOut"] = res.getOutput("aoNormal");
+    mpDownsampleInputsPass->execute(ctx.pRenderContext, uint3(pLowDepth->getWidth(), pLowDepth->getHeight(), 1));
+}
+
+void SSAOTechnique::upsampleAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+{
+    const ref<Texture>& pDepth = res.getInput("depth");
+    const ref<Texture>& pLowAO = res.getInput("aoMapLow");
+    GBuffer::updatePassDefines(mpUpsamplePass.get(), ctx.gbufferDefines);
+    auto var = mpUpsamplePass->getRootVar();
+    ctx.pCamera->bindShaderData(var["PerFrameCB"]["gCamera"]);
+    var["PerFrameCB"]["gFullResDim"] = uint2(pDepth->getWidth(), pDepth->getHeight());
+    var["PerFrameCB"]["gLowResDim"] = uint2(pLowAO->getWidth(), pLowAO->getHeight());
+    var["PerFrameCB"]["gFactor"] = (pDepth->getWidth() + pLowAO->getWidth() - 1) / pLowAO->getWidth();
+    var["PerFrameCB"]["gDepthSigma"] = mUpsampleDepthSigma;
+    var["PerFrameCB"]["gNormalPower"] = mUpsampleNormalPower;
+    var["gDepth"] = pDepth;
+    var["gNormal"] = res.getInput("normW");
+    var["gLowDepth"] = res.getInput("aoDepth");
+    var["gLowNormal"] = res.getInput("aoNormal");
+    var["gLowAO"] = pLowAO;
+    var["gAOOut"] = res.getOutput("aoMap");
+    mpUpsamplePass->execute(ctx.pRenderContext, uint3(pDepth->getWidth(), pDepth->getHeight(), 1));
+}
+
+void SSAOTechnique::generateAOMapGTAO(
+    const TechniqueGraph::FrameContext& ctx,
+    const ref<Texture>& pDepthTexture,
+    const ref<Texture>& pNormalTexture,
+    const ref<Texture>& pDepthMips,
+    const ref<Texture>& pAoMap,
+    uint32_t sliceCount,
+    uint32_t stepCount,
+    float noiseOffset
+)
+{
+    GBuffer::updatePassDefines(mpGTAOPass.get(), ctx.gbufferDefines);
+    const float4x4 proj = ctx.pCamera->getProjMatrix();
+    const uint2 dim = uint2(pAoMap->getWidth(), pAoMap->getHeight());
+    auto var = mpGTAOPass->getRootVar();
+    ctx.pCamera->bindShaderData(var["PerFrameCB"]["gCamera"]);
+    var["PerFrameCB"]["gInvProj"] = math::inverse(proj);
+    var["PerFrameCB"]["gDim"] = dim;
+    var["PerFrameCB"]["gSliceCount"] = sliceCount;
+    var["PerFrameCB"]["gStepCount"] = stepCount;
+    var["PerFrameCB"]["gRadius"] = mData.radius;
+    var["PerFrameCB"]["gFalloff"] = mGTAOFalloff;
+    var["PerFrameCB"]["gProjScale"] = proj[1][1] * 0.5f * dim.y;
+    var["PerFrameCB"]["gMipOffset"] = kGTAOMipOffset;
+    var["PerFrameCB"]["gMaxMip"] = pDepthMips->getMipCount() - 1;
+    var["PerFrameCB"]["gNoiseOffset"] = noiseOffset;
+    var["gPointSampler"] = mpPointSampler;
+    var["gDepth"] = pDepthTexture;
+    var["gNormal"] = pNormalTexture;
+    var["gDepthMips"] = pDepthMips;
+    var["gAOOut"] = pAoMap;
+    mpGTAOPass->execute(ctx.pRenderContext, uint3(dim, 1));
+}
+
+void SSAOTechnique::generateAOReference(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+{
+    GBuffer::updatePassDefines(mpAOReferencePass.get(), ctx.gbufferDefines);
+    const float4x4 proj = ctx.pCamera->getProjMatrix();
+    const ref<Texture>& pAoOut = res.getOutput("aoReference");
+    const uint2 dim = uint2(pAoOut->getWidth(), pAoOut->getHeight());
+    auto var = mpAOReferencePass->getRootVar();
+    ctx.pCamera->bindShaderData(var["PerFrameCB"]["gCamera"]);
+    var["PerFrameCB"]["gProj"] = proj;
+    var["PerFrameCB"]["gInvProj"] = math::inverse(proj);
+    var["PerFrameCB"]["gDim"] = dim;
+    var["PerFrameCB"]["gRayCount"] = kReferenceRayCount;
+    var["PerFrameCB"]["gStepCount"] = kReferenceStepCount;
+    var["PerFrameCB"]["gRadius"] = mData.radius;
+    var["PerFrameCB"]["gFalloff"] = mGTAOFalloff;
+    var["gDepth"] = res.getInput("depth");
+    var["gNormal"] = res.getInput("normW");
+    var["gAOOut"] = pAoOut;
+    mpAOReferencePass->execute(ctx.pRenderContext, uint3(dim, 1));
+}
+
+void SSAOTechnique::blurAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res, uint32_t axis)
+{
+    const ref<Texture>& pAoOut = res.getOutput(axis == 0 ? "aoBlurX" : "aoMap");
+    const uint2 dim = uint2(pAoOut->getWidth(), pAoOut->getHeight());
+    ComputePass* pPass = mpAOBlurPass[axis].get();
+    GBuffer::updatePassDefines(pPass, ctx.gbufferDefines);
+    auto var = pPass->getRootVar();
+    ctx.pCamera->bindShaderData(var["PerFrameCB"]["gCamera"]);
+    var["PerFrameCB"]["gDim"] = dim;
+    var["PerFrameCB"]["gRadius"] = std::min(mAOBlurRadius, kMaxAOBlurRadius);
+    var["PerFrameCB"]["gSpatialSigma"] = std::max(0.5f, mAOBlurRadius * 0.5f);
+    var["PerFrameCB"]["gDepthSigma"] = mAOBlurDepthSigma;
+    var["PerFrameCB"]["gNormalPower"] = mAOBlurNormalPower;
+    var["gAO"] = res.getInput(axis == 0 ? "aoMap" : "aoBlurX");
+    var["gDepth"] = res.getInput("depth");
+    var["gNormal"] = res.getInput("normW");
+    var["gAOOut"] = pAoOut;
+    pPass->execute(ctx.pRenderContext, uint3(dim, 1));
+}
+
+void SSAOTechnique::compareAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+{
+    RenderContext* pRenderContext = ctx.pRenderContext;
+    const ref<Texture>& pAoMap = res.getInput("aoMap");
+    const uint2 dim = uint2(pAoMap->getWidth(), pAoMap->getHeight());
+
+    // Read back the error of an older frame, its copy has completed by now.
+    uint32_t slot = mCompareFrame % (kReadbackLatency + 1);
+    if (mCompareFrame >= kReadbackLatency)
+    {
+        uint32_t oldest = (mCompareFrame + 1) % (kReadbackLatency + 1);
+        const uint32_t* pError = static_cast<const uint32_t*>(mpErrorReadback[oldest]->map(Buffer::MapType::Read));
+        BackendReport& report = mReports[(uint32_t)mErrorBackend[oldest]];
+        report.meanError = pError[0] / (255.0f * mErrorPixelCount[oldest]);
+        report.maxError = pError[1] / 255.0f;
+        report.valid = true;
+        mpErrorReadback[oldest]->unmap();
+    }
+
+    pRenderContext->clearUAV(mpErrorBuffer->getUAV().get(), uint4(0));
+    auto var = mpComparePass->getRootVar();
+    var["PerFrameCB"]["gDim"] = dim;
+    var["gAO"] = pAoMap;
+    var["gReference"] = res.getInput("aoReference");
+    var["gCompareOut"] = res.getOutput("aoCompare");
+    var["gError"] = mpErrorBuffer;
+    mpComparePass->execute(pRenderContext, uint3(dim, 1));
+    pRenderContext->copyBufferRegion(mpErrorReadback[slot].get(), 0, mpErrorBuffer.get(), 0, 2 * sizeof(uint32_t));
+    mErrorBackend[slot] = mBackend;
+    mErrorPixelCount[slot] = dim.x * dim.y;
+    mCompareFrame++;
+
+    // The profiler averages every node over the frames it ran in, so the nodes of the current configuration suffice.
+    if (ctx.pProfiler)
+    {
+        std::vector<std::string> nodes;
+        if (mBackend == AOBackend::GTAO)
+            nodes = {"generateAOMapGTAO"};
+        else if (mResolution == AOResolution::Full)
+            nodes = {"generateAOMap"};
+        else
+            nodes = {"downsampleAOInputs", "generateAOMapLowRes", "upsampleAO"};
+        if (mTemporal)
+            nodes.push_back("accumulateAO");
+        if (mBlurAO)
+            nodes.insert(nodes.end(), {"blurAOX", "blurAOY"});
+        double gpuMs = 0.0;
+        for (const auto& node : nodes)
+            gpuMs += ctx.pProfiler->getStats(node).gpuAvg;
+        mReports[(uint32_t)mBackend].gpuMs = gpuMs;
+        mReferenceGpuMs = ctx.pProfiler->getStats("generateAOReference").gpuAvg;
+    }
+}
+
+void SSAOTechnique::blurMap(const TechniqueGraph::FrameContext& ctx, const ref<Texture>& pSrc, const ref<Texture>& pDst, uint32_t downSample)
+{
+    RenderContext* pRenderContext = ctx.pRenderContext;
     const uint2 resolution = uint2(pSrc->getWidth(), pSrc->getHeight());
-    auto var = mpDownsamplePass->getRootVar();
-    var["gLinearSampler"] = gSampler;
-    for (uint32_t level = 0; level < downSample; ++level)
     {
-        uint2 res = {std::max(1u, resolution.x >> (level + 1)), std::max(1u, resolution.y >> (level + 1))};
-        float2 invres = float2(1.f / res.x, 1.f / res.y);
-        var["PerFrameCB"]["gResolution"] = res;
-        var["PerFrameCB"]["gInvRes"] = invres;
-        var["gSrc"] = level > 0 ? mpDownsampleTexture[level - 1] : pSrc;
-        var["gDst"] = mpDownsampleTexture[level];
-        mpDownsamplePass->execute(pRenderContext, uint3(res, 1));
+        PASS_PROFILE(ctx.pProfiler, pRenderContext, "pyramid");
+        mpBlurPyramid->build(pRenderContext, pSrc, downSample);
     }
-    var = mpMergePass->getRootVar();
+    auto var = mpMergePass->getRootVar();
+    var["gLinearSampler"] = ctx.pSampler;
     var["PerFrameCB"]["gResolution"] = resolution;
     float2 invres = float2(1.f / resolution.x, 1.f / resolution.y);
     var["PerFrameCB"]["gInvRes"] = invres;
-    var["gDst"] = mpMergedBlurTexture;
+    var["gDst"] = pDst;
     var["gSampleCount"] = downSample;
-    for (uint32_t level = 0; level < downSample; ++level)
-    {
-        var["gSrcArray"][level] = mpDownsampleTexture[level];
-    }
+    var["gPyramid"] = mpBlurPyramid->getTexture();
+    PASS_PROFILE(ctx.pProfiler, pRenderContext, "merge");
     mpMergePass->execute(pRenderContext, uint3(resolution, 1));
 }
 
-void SSAO::onLoad(RenderContext* pRenderContext)
+void SSAOTechnique::onLoad(const ref<Device>& pDevice, TechniqueGraph& graph)
 {
+    mpDevice = pDevice;
+    mpGraph = &graph;
+
     Sampler::Desc samplerDesc;
     samplerDesc.setFilterMode(TextureFilteringMode::Point, TextureFilteringMode::Point, TextureFilteringMode::Point)
         .setAddressingMode(TextureAddressingMode::Wrap, TextureAddressingMode::Wrap, TextureAddressingMode::Wrap);
-    mpNoiseSampler = getDevice()->createSampler(samplerDesc);
+    mpNoiseSampler = pDevice->createSampler(samplerDesc);
 
-    mpSSAOPass = FullScreenPass::create(getDevice(), "Samples/SampleAppTemplate/SSAO.ps.slang");
+    mpSSAOPass = FullScreenPass::create(pDevice, "Samples/SampleAppTemplate/SSAO.ps.slang");
 
     // mpBlurGraph = GaussianBlur::create(getDevice(), mBlurDict);
 
-    mComposeData.pApplySSAOPass = FullScreenPass::create(getDevice(), "Samples/SampleAppTemplate/SSAOApply.ps.slang");
-    mComposeData.pApplySSAOPass->getRootVar()["gSampler"] = gSampler;
-    mComposeData.pFbo = Fbo::create(getDevice());
+    mComposeData.pApplySSAOPass = FullScreenPass::create(pDevice, "Samples/SampleAppTemplate/SSAOApply.ps.slang");
+    mComposeData.pFbo = Fbo::create(pDevice);
+    mpAOFbo = Fbo::create(pDevice);
 
-    ref<Texture> aoTex = getDevice()->createTexture2D(
-        mAoMapSize.x,
-        mAoMapSize.y,
-        ResourceFormat::R8Unorm,
-        1,
-        1,
-        nullptr,
-        ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget
-    );
-    mpAOFbo = Fbo::create(getDevice());
-    mpAOFbo->attachColorTarget(aoTex, 0);
+    mpDownsampleInputsPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/SSAOResample.cs.slang", "downsampleDepthNormal");
+    mpUpsamplePass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/SSAOResample.cs.slang", "upsampleAO");
+    samplerDesc.setAddressingMode(TextureAddressingMode::Clamp, TextureAddressingMode::Clamp, TextureAddressingMode::Clamp);
+    mpPointSampler = pDevice->createSampler(samplerDesc);
 
-    mpDownsamplePass = ComputePass::create(getDevice(), "Samples/SampleAppTemplate/Blur.cs.slang", "downsample");
-    mpMergePass = ComputePass::create(getDevice(), "Samples/SampleAppTemplate/Blur.cs.slang", "merge");
-    for (uint32_t i = 0; i < DOWNSAMPLE_COUNT; i++)
-    {
-        uint32_t blurScale = 1 << (i + 1);
-        mpDownsampleTexture[i] = getDevice()->createTexture2D(
-            mAoMapSize.x / blurScale,
-            mAoMapSize.y / blurScale,
-            ResourceFormat::RGBA16Float,
-            1,
-            1,
-            nullptr,
-            ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-        );
-    }
+    mpGTAOPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/GTAO.cs.slang", "main");
+    mpAOReferencePass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/AOReference.cs.slang", "main");
+    mpDepthMips = std::make_unique<HiZPyramid>(pDevice);
 
-    mpMergedBlurTexture = getDevice()->createTexture2D(
-        mAoMapSize.x,
-        mAoMapSize.y,
-        ResourceFormat::RGBA16Float,
-        1,
-        1,
-        nullptr,
-        ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+    mpTemporalPass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/SSAOTemporal.cs.slang", "main");
+
+    mpAOBlurPass[0] = ComputePass::create(pDevice, "Samples/SampleAppTemplate/SSAOBlur.cs.slang", "blurX");
+    mpAOBlurPass[1] = ComputePass::create(pDevice, "Samples/SampleAppTemplate/SSAOBlur.cs.slang", "blurY");
+
+    mpComparePass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/AOCompare.cs.slang", "main");
+    mpErrorBuffer = pDevice->createBuffer(
+        2 * sizeof(uint32_t), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr
     );
+    for (auto& pReadback : mpErrorReadback)
+        pReadback = pDevice->createBuffer(2 * sizeof(uint32_t), ResourceBindFlags::None, MemoryType::ReadBack, nullptr);
+
+    mpBlurPyramid = std::make_unique<MipPyramid>(pDevice, ResourceFormat::RGBA16Float);
+    mpMergePass = ComputePass::create(pDevice, "Samples/SampleAppTemplate/Blur.cs.slang", "merge");
+
     setSampleRadius(0.5f);
     setKernelSize(32);
     setNoiseTexture(mNoiseSize.x, mNoiseSize.y);
 
-    GBuffer::onLoad(pRenderContext);
+    graph.addNode({
+        "generateAOMap",
+        {"depth", "normW"},
+        {{"aoMap", ResourceFormat::R8Unorm}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        { generateAOMap(ctx, res.getInput("depth"), res.getInput("normW"), res.getOutput("aoMap"), ctx.pSampler); },
+        [this]() { return enableSSAO && mBackend == AOBackend::HemisphereKernel && mResolution == AOResolution::Full; },
+    });
+    graph.addNode({
+        "downsampleAOInputs",
+        {"depth", "normW"},
+        {{"aoDepth", ResourceFormat::RG32Float, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess},
+         {"aoNormal", ResourceFormat::RGBA16Float, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { downsampleAOInputs(ctx, res); },
+        [this]() { return enableSSAO && mBackend == AOBackend::HemisphereKernel && mResolution != AOResolution::Full; },
+    });
+    graph.addNode({
+        "generateAOMapLowRes",
+        {"aoDepth", "aoNormal"},
+        {{"aoMapLow", ResourceFormat::R8Unorm}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        { generateAOMap(ctx, res.getInput("aoDepth"), res.getInput("aoNormal"), res.getOutput("aoMapLow"), mpPointSampler); },
+        [this]() { return enableSSAO && mBackend == AOBackend::HemisphereKernel && mResolution != AOResolution::Full; },
+    });
+    graph.addNode({
+        "upsampleAO",
+        {"aoMapLow", "aoDepth", "aoNormal", "depth", "normW"},
+        {{"aoMap", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { upsampleAO(ctx, res); },
+        [this]() { return enableSSAO && mBackend == AOBackend::HemisphereKernel && mResolution != AOResolution::Full; },
+    });
+    graph.addNode({
+        "generateAOMapGTAO",
+        {"depth", "normW"},
+        {{"aoMap", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        {
+            const ref<Texture>& pDepth = res.getInput("depth");
+            mpDepthMips->build(ctx.pRenderContext, pDepth);
+            // Golden ratio increments rotate the slices through the whole circle over successive frames.
+            float noiseOffset = mTemporal ? (float)std::fmod(ctx.frameIndex * 0.618034, 1.0) : 0.0f;
+            generateAOMapGTAO(
+                ctx,
+                pDepth,
+                res.getInput("normW"),
+                mpDepthMips->getTexture(),
+                res.getOutput("aoMap"),
+                mGTAOSliceCount,
+                mGTAOStepCount,
+                noiseOffset
+            );
+        },
+        [this]() { return enableSSAO && mBackend == AOBackend::GTAO; },
+    });
+    graph.addNode({
+        "accumulateAO",
+        {"aoMap", "mvec", "depth"},
+        {{"aoMap", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { accumulateAO(ctx, res); },
+        [this]() { return enableSSAO && mTemporal; },
+    });
+    graph.addNode({
+        "blurAOX",
+        {"aoMap", "depth", "normW"},
+        {{"aoBlurX", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { blurAO(ctx, res, 0); },
+        [this]() { return enableSSAO && mBlurAO; },
+    });
+    graph.addNode({
+        "blurAOY",
+        {"aoBlurX", "depth", "normW"},
+        {{"aoMap", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { blurAO(ctx, res, 1); },
+        [this]() { return enableSSAO && mBlurAO; },
+    });
+    graph.addNode({
+        "generateAOReference",
+        {"depth", "normW"},
+        {{"aoReference", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        { generateAOReference(ctx, res); },
+        [this]() { return enableSSAO && mCompareBackends; },
+    });
+    graph.addNode({
+        "compareAO",
+        {"aoMap", "aoReference"},
+        {{"aoCompare", ResourceFormat::R8Unorm, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res) { compareAO(ctx, res); },
+        [this]() { return enableSSAO && mCompareBackends; },
+    });
+    graph.addNode({
+        "applyAO",
+        {"color", "aoMap"},
+        {{"color"}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        {
+            ShaderVar var = mComposeData.pApplySSAOPass->getRootVar();
+            var["gSampler"] = ctx.pSampler;
+            var["gColor"] = res.getInput("color");
+            var["gAOMap"] = res.getInput("aoMap");
+            mComposeData.pFbo->attachColorTarget(res.getOutput("color"), 0);
+            mComposeData.pApplySSAOPass->execute(ctx.pRenderContext, mComposeData.pFbo);
+        },
+        [this]() { return enableSSAO; },
+    });
+    graph.addNode({
+        "blurMap",
+        {"color"},
+        {{"color", ResourceFormat::RGBA16Float, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        { blurMap(ctx, res.getInput("color"), res.getOutput("color"), blurImage); },
+        [this]() { return !enableSSAO && blurImage > 0; },
+    });
 }
 
-void SSAO::onShutdown()
+void SSAOTechnique::onGuiRender(Gui* pGui)
 {
-    GBuffer::onShutdown();
-}
-
-void SSAO::onResize(uint32_t width, uint32_t height) {}
+    Gui::Window w(pGui, "Falcor", {250, 500});
+    uint32_t backend = (uint32_t)mBackend;
+    if (w.dropdown("AO Backend", kBackendDropdown, backend))
+        mBackend = (AOBackend)backend;
 
-void SSAO::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
-{
-    GBuffer::onFrameRender(pRenderContext, mpFbo);
-    // Run the AO pass
-    if (mShowNoiseTex)
-    {
-        pRenderContext->blit(mpNoiseTexture->getSRV(), pTargetFbo->getRenderTargetView(0));
-        return;
-    }
-    if (enableSSAO)
+    if (mBackend == AOBackend::HemisphereKernel)
     {
-        auto pAoMap = generateAOMap(pRenderContext, mpCamera.get(), mpDepthRT, mpNoiseTexture, mpRTs[2]);
+        uint32_t distribution = (uint32_t)mHemisphereDistribution;
+        if (w.dropdown("Kernel Distribution", kDistributionDropdown, distribution))
+            setDistribution(distribution);
 
-        if (showSSAOMap)
-        {
-            pRenderContext->blit(pAoMap->getSRV(), pTargetFbo->getRenderTargetView(0));
-            return;
-        }
-        ShaderVar var = mComposeData.pApplySSAOPass->getRootVar();
-        var["gColor"] = mpRTs[0];
-        var["gAOMap"] = pAoMap;
-        mComposeData.pFbo->attachColorTarget(pTargetFbo->getColorTexture(0), 0);
-        mComposeData.pApplySSAOPass->execute(pRenderContext, mComposeData.pFbo);
+        uint32_t size = mData.kernelSize;
+        if (w.var("Kernel Size", size, 1u, SSAOData::kMaxSamples))
+            setKernelSize(size);
     }
     else
     {
-        if (blurImage > 0)
-        {
-            blurMap(pRenderContext, mpRTs[0], blurImage);
-            //pRenderContext->blit(mpDownsampleTexture[blurImage]->getSRV(), pTargetFbo->getRenderTargetView(0));
-            pRenderContext->blit(mpMergedBlurTexture->getSRV(), pTargetFbo->getRenderTargetView(0));
-        }
-        else
-        {
-            pRenderContext->blit(mpRTs[0]->getSRV(), pTargetFbo->getRenderTargetView(0));
-        }
+        w.var("GTAO Slices", mGTAOSliceCount, 1u, 8u);
+        w.var("GTAO Steps", mGTAOStepCount, 1u, 16u);
+        w.var("GTAO Falloff", mGTAOFalloff, 0.01f, 1.0f, 0.01f);
     }
-}
-
-void SSAO::onGuiRender(Gui* pGui)
-{
-    GBuffer::onGuiRender(pGui);
-
-    Gui::Window w(pGui, "Falcor", {250, 500});
-    uint32_t distribution = (uint32_t)mHemisphereDistribution;
-    if (w.dropdown("Kernel Distribution", kDistributionDropdown, distribution))
-        setDistribution(distribution);
-
-    uint32_t size = mData.kernelSize;
-    if (w.var("Kernel Size", size, 1u, SSAOData::kMaxSamples))
-        setKernelSize(size);
 
     float radius = mData.radius;
     if (w.var("Sample Radius", radius, 0.001f, FLT_MAX, 0.001f))
         setSampleRadius(radius);
 
-    w.checkbox("SSAO", enableSSAO);
-    if (enableSSAO)
+    if (mBackend == AOBackend::HemisphereKernel)
     {
-        w.checkbox("SSAO Map", showSSAOMap);
-        w.checkbox("Show Noise Texture", mShowNoiseTex);
+        uint32_t resolution = (uint32_t)mResolution;
+        if (w.dropdown("AO Resolution", kResolutionDropdown, resolution))
+            setResolution((AOResolution)resolution);
+        if (mResolution != AOResolution::Full)
+        {
+            w.var("Upsample Depth Sigma", mUpsampleDepthSigma, 0.001f, 1.0f, 0.001f);
+            w.var("Upsample Normal Power", mUpsampleNormalPower, 0.0f, 64.0f, 1.0f);
+        }
     }
-    else
+
+    bool temporal = mTemporal;
+    if (w.checkbox("Temporal Accumulation", temporal))
+        setTemporal(temporal);
+    w.tooltip("Rotates the samples every frame and accumulates the AO over time, 4 to 8 samples per frame suffice.");
+    if (mTemporal)
     {
-        w.slider("Show Blur", blurImage, (uint32_t)0, DOWNSAMPLE_COUNT - 1);
+        w.var("History Length", mMaxHistory, 1u, 64u);
+        w.var("History Depth Tolerance", mHistoryDepthTolerance, 0.001f, 1.0f, 0.001f);
     }
-}
 
-bool SSAO::onKeyEvent(const KeyboardEvent& keyEvent)
-{
-    return GBuffer::onKeyEvent(keyEvent);
-}
+    w.checkbox("AO Blur", mBlurAO);
+    if (mBlurAO)
+    {
+        w.var("AO Blur Radius", mAOBlurRadius, 1u, kMaxAOBlurRadius);
+        w.var("AO Blur Depth Sigma", mAOBlurDepthSigma, 0.001f, 1.0f, 0.001f);
+        w.var("AO Blur Normal Power", mAOBlurNormalPower, 0.0f, 64.0f, 1.0f);
+    }
 
-bool SSAO::onMouseEvent(const MouseEvent& mouseEvent)
-{
-    return GBuffer::onMouseEvent(mouseEvent);
+    w.checkbox("SSAO", enableSSAO);
+    if (enableSSAO && w.checkbox("Compare Backends", mCompareBackends))
+    {
+        // The comparison only runs while its output is presented.
+        mpGraph->setOutput(mCompareBackends ? "aoCompare" : "color");
+        mCompareFrame = 0;
+    }
+    if (enableSSAO && mCompareBackends)
+    {
+        w.text("Left: selected backend, right: reference");
+        auto reportRow = [](const char* name, const BackendReport& report)
+        {
+            if (!report.valid)
+                return fmt::format("{}: select it to measure", name);
+            return fmt::format("{}: {:.3f} ms, mean error {:.4f}, max error {:.3f}", name, report.gpuMs, report.meanError, report.maxError);
+        };
+        w.text(reportRow("Hemisphere Kernel", mReports[(uint32_t)AOBackend::HemisphereKernel]));
+        w.text(reportRow("GTAO", mReports[(uint32_t)AOBackend::GTAO]));
+        w.text(fmt::format("Reference: {:.3f} ms", mReferenceGpuMs));
+    }
+    if (!enableSSAO)
+    {
+        w.slider("Show Blur", blurImage, (uint32_t)0, DOWNSAMPLE_COUNT - 1);
+        bool binomial = mpBlurPyramid->getReduction() == MipPyramid::Reduction::Binomial;
+        if (w.checkbox("Binomial Pyramid", binomial))
+        {
+            MipPyramid::Reduction reduction = binomial ? MipPyramid::Reduction::Binomial : MipPyramid::Reduction::Average;
+            mpBlurPyramid = std::make_unique<MipPyramid>(mpDevice, ResourceFormat::RGBA16Float, reduction);
+        }
+        w.tooltip(
+            "Off (default): 2x2 box averages built in a single dispatch, blockier at the coarse levels.\n"
+            "On: every level is a 10x10 binomial of the level above, smoother but one dispatch per level."
+        );
+    }
 }
 
-void SSAO::onHotReload(HotReloadFlags reloaded)
+SSAO::SSAO(const SampleAppConfig& config) : GBuffer(config)
 {
-    GBuffer::onHotReload(reloaded);
+    addTechnique(std::make_shared<SSAOTechnique>());
 }
 
-void SSAO::loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo)
+SSAO::~SSAO()
 {
-    GBuffer::loadScene(path, pTargetFbo);
+    //
 }
@@ -1,11 +1,33 @@
 #pragma once
 #include "Falcor.h"
 #include "GBuffer.h"
+#include "HiZPyramid.h"
+#include "MipPyramid.h"
 #include "Core/Pass/RasterPass.h"
 
 using namespace Falcor;
 
-class SSAO : public GBuffer
+/** Screen-space ambient occlusion with two backends. Adds these nodes:
+    - with the hemisphere kernel backend, "generateAOMap" (depth, normW -> aoMap), at full resolution;
+    - with the hemisphere kernel backend at half or quarter resolution instead: "downsampleAOInputs" (depth, normW
+      -> aoDepth, aoNormal), "generateAOMapLowRes" (aoDepth, aoNormal -> aoMapLow) and "upsampleAO" (aoMapLow, aoDepth,
+      aoNormal, depth, normW -> aoMap), a joint bilateral upsampling that keeps AO from bleeding across depth edges;
+    - with the GTAO backend, "generateAOMapGTAO" (depth, normW -> aoMap), a compute horizon search over a few
+      screen-space slices, which reads a depth mip chain for the long steps;
+    - with temporal accumulation, "accumulateAO" (aoMap, mvec, depth -> aoMap), which blends the AO map into a
+      reprojected history so that a few samples per frame converge to the quality of many. Both backends then rotate
+      their samples every frame;
+    - with the AO blur, "blurAOX" (aoMap, depth, normW -> aoBlurX) and "blurAOY" (aoBlurX, depth, normW -> aoMap),
+      a separable bilateral blur that removes the noise pattern without crossing depth or normal edges;
+    - while comparing the backends, "generateAOReference" (depth, normW -> aoReference), a brute-force integration of
+      cosine-weighted rays marched through the full resolution depth with the radius and falloff of the backends, and
+      "compareAO" (aoMap, aoReference -> aoCompare), which shows both side by side and measures the error of the AO
+      map;
+    - "applyAO" (color, aoMap -> color);
+    - "blurMap" (color -> color), the blur demo, which runs while SSAO is off.
+    The noise texture is imported as "ssaoNoise" so it can be viewed through the graph output.
+ */
+class SSAOTechnique : public GBufferTechnique
 {
 public:
     enum class SampleDistribution : uint32_t
@@ -14,6 +36,19 @@ public:
         UniformHammersley,
         CosineHammersley
     };
+    /// Resolution the AO is computed at, relative to the render resolution.
+    enum class AOResolution : uint32_t
+    {
+        Full,
+        Half,
+        Quarter
+    };
+    /// Algorithm computing the AO map.
+    enum class AOBackend : uint32_t
+    {
+        HemisphereKernel,
+        GTAO
+    };
     struct SSAOData
     {
         static const uint32_t kMaxSamples = 32;
@@ -24,9 +59,9 @@ public:
         float radius = 0.1f;
     };
 
-public:
-    SSAO(const SampleAppConfig& config);
-    ~SSAO();
+    std::string getName() const override { return "SSAO"; }
+    void onLoad(const ref<Device>& pDevice, TechniqueGraph& graph) override;
+    void onGuiRender(Gui* pGui) override;
 
     void setSampleRadius(float radius);
     void setKernelSize(uint32_t kernelSize);
@@ -34,44 +69,108 @@ public:
     void setKernel();
     void setNoiseTexture(uint32_t width, uint32_t height);
 
-    ref<Texture> generateAOMap(
-        RenderContext* pRenderContext,
-        const Camera* pCamera,
+    void setResolution(AOResolution resolution);
+    void setTemporal(bool temporal);
+    void generateAOMap(
+        const TechniqueGraph::FrameContext& ctx,
         const ref<Texture>& pDepthTexture,
-        const ref<Texture>& pNoiseTexture,
-        const ref<Texture>& pNormalTexture
+        const ref<Texture>& pNormalTexture,
+        const ref<Texture>& pAoMap,
+        const ref<Sampler>& pDepthSampler
     );
-    void blurMap(RenderContext* pRenderContext, const ref<Texture>& pDepthTexture, uint32_t downSample);
-    void onLoad(RenderContext* pRenderContext) override;
-    void onShutdown() override;
-    void onResize(uint32_t width, uint32_t height) override;
-    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
-    void onGuiRender(Gui* pGui) override;
-    bool onKeyEvent(const KeyboardEvent& keyEvent) override;
-    bool onMouseEvent(const MouseEvent& mouseEvent) override;
-    void onHotReload(HotReloadFlags reloaded) override;
-    void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo);
+    void downsampleAOInputs(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res);
+    void upsampleAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res);
+    void generateAOMapGTAO(
+        const TechniqueGraph::FrameContext& ctx,
+        const ref<Texture>& pDepthTexture,
+        const ref<Texture>& pNormalTexture,
+        const ref<Texture>& pDepthMips,
+        const ref<Texture>& pAoMap,
+        uint32_t sliceCount,
+        uint32_t stepCount,
+        float noiseOffset
+    );
+    void generateAOReference(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res);
+    void accumulateAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res);
+    void blurAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res, uint32_t axis);
+    void compareAO(const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res);
+    void blurMap(const TechniqueGraph::FrameContext& ctx, const ref<Texture>& pSrc, const ref<Texture>& pDst, uint32_t downSample);
+
+    bool enableSSAO = false;
 
 private:
+    float getRandomFloat() { return mDistReal(mRng); }
+    /// Number of kernel samples in mData, of which every frame uses kernelSize.
+    uint32_t getSequenceSize() const { return mTemporal ? SSAOData::kMaxSamples : mData.kernelSize; }
+
+    ref<Device> mpDevice;
+    TechniqueGraph* mpGraph = nullptr;
     ref<FullScreenPass> mpSSAOPass;
     ref<Fbo> mpAOFbo;
 
-    static const uint32_t DOWNSAMPLE_COUNT = 4;
+    AOResolution mResolution = AOResolution::Full;
+    ref<ComputePass> mpDownsampleInputsPass, mpUpsamplePass;
+    /// Low resolution depth holds min/max pairs, which must not be filtered.
+    ref<Sampler> mpPointSampler;
+    float mUpsampleDepthSigma = 0.05f;
+    float mUpsampleNormalPower = 8.0f;
 
-    ref<ComputePass> mpDownsamplePass, mpMergePass;
-    ref<Texture> mpDownsampleTexture[DOWNSAMPLE_COUNT];
-    ref<Texture> mpMergedBlurTexture;
+    AOBackend mBackend = AOBackend::HemisphereKernel;
+    ref<ComputePass> mpGTAOPass;
+    ref<ComputePass> mpAOReferencePass;
+    std::unique_ptr<HiZPyramid> mpDepthMips;
+    uint32_t mGTAOSliceCount = 2;
+    uint32_t mGTAOStepCount = 4;
+    float mGTAOFalloff = 0.4f;
 
-    uint2 mAoMapSize = uint2(2048, 1024);
+    /// Temporal accumulation ping-pongs between two histories holding AO, view depth and accumulated frame count.
+    bool mTemporal = false;
+    uint32_t mMaxHistory = 8;
+    float mHistoryDepthTolerance = 0.05f;
+    ref<ComputePass> mpTemporalPass;
+    ref<Texture> mpAOHistory[2];
+    uint32_t mHistoryIndex = 0;
+    uint32_t mLastAccumulatedFrame = 0;
+
+    /// Bilateral AO blur, one pass along X and one along Y.
+    static const uint32_t kMaxAOBlurRadius = 8;
+    bool mBlurAO = true;
+    uint32_t mAOBlurRadius = 4;
+    float mAOBlurDepthSigma = 0.05f;
+    float mAOBlurNormalPower = 8.0f;
+    ref<ComputePass> mpAOBlurPass[2];
+
+    /// Backend comparison: the error of a frame is read back kReadbackLatency frames later.
+    struct BackendReport
+    {
+        bool valid = false;
+        double gpuMs = 0.0;
+        float meanError = 0.0f;
+        float maxError = 0.0f;
+    };
+    static const uint32_t kReadbackLatency = 2;
+    bool mCompareBackends = false;
+    ref<ComputePass> mpComparePass;
+    ref<Buffer> mpErrorBuffer;
+    ref<Buffer> mpErrorReadback[kReadbackLatency + 1];
+    AOBackend mErrorBackend[kReadbackLatency + 1] = {};
+    uint32_t mErrorPixelCount[kReadbackLatency + 1] = {};
+    uint64_t mCompareFrame = 0;
+    BackendReport mReports[2];
+    double mReferenceGpuMs = 0.0;
+
+    static const uint32_t DOWNSAMPLE_COUNT = 4;
+
+    std::unique_ptr<MipPyramid> mpBlurPyramid;
+    ref<ComputePass> mpMergePass;
 
-    bool enableSSAO = false;
-    bool showSSAOMap = false;
-    bool mShowNoiseTex = false;
     uint32_t blurImage = 0;
 
     SSAOData mData;
     bool mDirty = false;
     SampleDistribution mHemisphereDistribution = SampleDistribution::CosineHammersley;
+    std::mt19937 mRng;
+    std::uniform_real_distribution<float> mDistReal = std::uniform_real_distribution<float>(0.0f, 1.0f);
 
     ref<Sampler> mpNoiseSampler;
     ref<Texture> mpNoiseTexture;
@@ -83,3 +182,10 @@ private:
         ref<Fbo> pFbo;
     } mComposeData;
 };
+
+class SSAO : public GBuffer
+{
+public:
+    SSAO(const SampleAppConfig& config);
+    ~SSAO();
+};
@@ -5,19 +5,24 @@
 
 using namespace Falcor;
 
-class SSR : public GBuffer
+/// Screen-space reflections, one node "SSR" (color, normW, depth -> color).
+class SSRTechnique : public GBufferTechnique
 {
 public:
-    SSR(const SampleAppConfig& config);
-    ~SSR();
-
-    void onLoad(RenderContext* pRenderContext) override;
-    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
+    std::string getName() const override { return "SSR"; }
+    void onLoad(const ref<Device>& pDevice, TechniqueGraph& graph) override;
     void onGuiRender(Gui* pGui) override;
-    void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo);
 
-private:
     bool enableSSR = false;
+
+private:
     ref<FullScreenPass> mpSSRPass;
     ref<Fbo> mpSsrFbo;
 };
+
+class SSR : public GBuffer
+{
+public:
+    SSR(const SampleAppConfig& config);
+    ~SSR();
+};
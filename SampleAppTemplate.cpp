@@ -42,6 +42,11 @@
 #include "SSR.h"
 #include "RayMarchingPrimitive.h"
 #include "PostProcess.h"
+#include "TechniqueStack.h"
+#include "Benchmark.h"
+#include "TangentGenerator.h"
+#include "MeshCache.h"
+#include "JobSystem.h"
 
 FALCOR_EXPORT_D3D12_AGILITY_SDK
 
@@ -152,6 +157,69 @@ void SampleAppTemplate::loadScene(const std::filesystem::path& path, const Fbo*
     mpRasterPass = RasterPass::create(getDevice(), rasterProgDesc, defines);
 }
 
+namespace
+{
+using SampleFactory = std::function<std::unique_ptr<SampleApp>(const SampleAppConfig&, const BenchmarkConfig&)>;
+
+template<typename T>
+SampleFactory makeSampleFactory()
+{
+    return [](const SampleAppConfig& config, const BenchmarkConfig& benchmarkConfig) -> std::unique_ptr<SampleApp>
+    {
+        if (benchmarkConfig.frameCount > 0)
+            return std::make_unique<Benchmark<T>>(config, benchmarkConfig);
+        return std::make_unique<T>(config);
+    };
+}
+
+const std::map<std::string, SampleFactory> kSampleFactories = {
+    {"BasicCube", makeSampleFactory<BasicCube>()},
+    {"RotateCube", makeSampleFactory<RotateCube>()},
+    {"ShadingCube", makeSampleFactory<ShadingCube>()},
+    {"BasicLight", makeSampleFactory<BasicLight>()},
+    {"ShadowMap", makeSampleFactory<ShadowMap>()},
+    {"NormalMap", makeSampleFactory<NormalMap>()},
+    {"PBR", makeSampleFactory<PBR>()},
+    {"MultiRenderTarget", makeSampleFactory<MultiRenderTarget>()},
+    {"ShaderSystemValue", makeSampleFactory<ShaderSystemValue>()},
+    {"DrawInstancing", makeSampleFactory<DrawInstancing>()},
+    {"FXAA", makeSampleFactory<FXAA>()},
+    {"SSAO", makeSampleFactory<SSAO>()},
+    {"TAA", makeSampleFactory<TAA>()},
+    {"SSR", makeSampleFactory<SSR>()},
+    {"RayMarchingPrimitive", makeSampleFactory<RayMarchingPrimitive>()},
+    {"PostProcess", makeSampleFactory<PostProcess>()},
+    {"TechniqueStack", makeSampleFactory<TechniqueStack>()},
+};
+
+void printUsage()
+{
+    std::string samples;
+    for (const auto& [name, factory] : kSampleFactories)
+        samples += " " + name;
+    std::cout << "Usage: SampleAppTemplate [options]\n"
+                 "  --sample <name>      Sample class to run (default SSR). One of:" << samples << "\n"
+                 "  --benchmark <frames> Render <frames> measured frames, write a report and exit\n"
+                 "  --warmup <frames>    Frames rendered before measuring starts (default 16)\n"
+                 "  --output <file>      Benchmark report, .json or .csv (default <sample>_benchmark.json)\n"
+                 "  --headless           Render offscreen without creating a window\n"
+                 "  --vulkan             Use the Vulkan backend (select a software ICD through VK_ICD_FILENAMES)\n"
+                 "  --gpu <index>        Adapter index\n"
+                 "  --width <pixels>     Frame width (default 2048)\n"
+                 "  --height <pixels>    Frame height (default 1024)\n"
+                 "  --gbuffer <layout>   G-buffer layout of the G-buffer based samples, full or compact (default full)\n"
+                 "  --render-scale <s>   Internal render resolution of the G-buffer based samples, 0.5 to 1 (default 1)\n"
+                 "  --postfx <mode>      PostProcess chain, fused or multipass (default fused)\n"
+                 "  --microbench-postfx <n> Measure the CPU cost of binding a chain of n PostFX effects, then exit\n"
+                 "  --instancing-sweep <file> Render DrawInstancing at 1K to 2M instances, write the frame times to a CSV file and exit\n"
+                 "  --microbench-tangents <n> Time tangent generation on a mesh of n triangles, then exit\n"
+                 "  --microbench-jobs <n> Time n batches of pass-sized jobs inline and on the JobSystem workers, then exit\n"
+                 "  --convert-mesh <file> Write the binary .fmesh conversion of a mesh file next to it, then exit\n"
+                 "  --mesh-layout <l>    Vertex layout of --convert-mesh: standard, tangent or compressed (default standard)\n"
+                 "  --smooth-normals     Smooth the normals in --convert-mesh (the samples load Arcade.fbx smoothed)\n";
+}
+} // namespace
+
 int runMain(int argc, char** argv)
 {
     SampleAppConfig config;
@@ -160,8 +228,128 @@ int runMain(int argc, char** argv)
     config.windowDesc.height = 1024;
     config.windowDesc.width = 2048;
 
-    SSR project(config);
-    return project.run();
+    BenchmarkConfig benchmarkConfig;
+    benchmarkConfig.sampleName = "SSR";
+    uint32_t tangentBenchmarkTriangles = 0;
+    uint32_t jobBenchmarkBatches = 0;
+    std::string convertMeshPath;
+    MeshVertexLayout convertMeshLayout = MeshVertexLayout::Standard;
+    bool convertMeshSmoothNormals = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto nextArg = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+                FALCOR_THROW("Missing value for command line option '{}'.", arg);
+            return argv[++i];
+        };
+
+        if (arg == "--sample")
+            benchmarkConfig.sampleName = nextArg();
+        else if (arg == "--benchmark")
+            benchmarkConfig.frameCount = std::stoul(nextArg());
+        else if (arg == "--warmup")
+            benchmarkConfig.warmupFrames = std::stoul(nextArg());
+        else if (arg == "--output")
+            benchmarkConfig.outputPath = nextArg();
+        else if (arg == "--headless")
+            config.headless = true;
+        else if (arg == "--vulkan")
+            config.deviceDesc.type = Device::Type::Vulkan;
+        else if (arg == "--gpu")
+            config.deviceDesc.gpu = std::stoul(nextArg());
+        else if (arg == "--width")
+            config.windowDesc.width = std::stoul(nextArg());
+        else if (arg == "--height")
+            config.windowDesc.height = std::stoul(nextArg());
+        else if (arg == "--gbuffer")
+        {
+            std::string layout = nextArg();
+            if (layout == "full")
+                GBuffer::sDefaultLayout = GBufferLayout::Full;
+            else if (layout == "compact")
+                GBuffer::sDefaultLayout = GBufferLayout::Compact;
+            else
+                FALCOR_THROW("Unknown G-buffer layout '{}', expected 'full' or 'compact'.", layout);
+        }
+        else if (arg == "--postfx")
+        {
+            std::string mode = nextArg();
+            if (mode == "fused")
+                PostProcess::sDefaultFusePointwise = true;
+            else if (mode == "multipass")
+                PostProcess::sDefaultFusePointwise = false;
+            else
+                FALCOR_THROW("Unknown PostFX mode '{}', expected 'fused' or 'multipass'.", mode);
+        }
+        else if (arg == "--microbench-postfx")
+        {
+            PostProcess::sMicrobenchmarkEffectCount = std::stoul(nextArg());
+            benchmarkConfig.sampleName = "PostProcess";
+        }
+        else if (arg == "--instancing-sweep")
+        {
+            DrawInstancing::sSweepOutputPath = nextArg();
+            benchmarkConfig.sampleName = "DrawInstancing";
+        }
+        else if (arg == "--microbench-tangents")
+            tangentBenchmarkTriangles = std::stoul(nextArg());
+        else if (arg == "--microbench-jobs")
+            jobBenchmarkBatches = std::stoul(nextArg());
+        else if (arg == "--convert-mesh")
+            convertMeshPath = nextArg();
+        else if (arg == "--mesh-layout")
+        {
+            std::string layout = nextArg();
+            if (layout == "standard")
+                convertMeshLayout = MeshVertexLayout::Standard;
+            else if (layout == "tangent")
+                convertMeshLayout = MeshVertexLayout::TangentSpace;
+            else if (layout == "compressed")
+                convertMeshLayout = MeshVertexLayout::TangentSpaceCompressed;
+            else
+                FALCOR_THROW("Unknown mesh layout '{}', expected 'standard', 'tangent' or 'compressed'.", layout);
+        }
+        else if (arg == "--smooth-normals")
+            convertMeshSmoothNormals = true;
+        else if (arg == "--render-scale")
+            GBuffer::sDefaultRenderScale = std::clamp(std::stof(nextArg()), 0.5f, 1.0f);
+        else
+        {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // CPU only, no device needed.
+    if (tangentBenchmarkTriangles > 0)
+    {
+        TangentGenerator::runBenchmark(tangentBenchmarkTriangles);
+        return 0;
+    }
+    if (jobBenchmarkBatches > 0)
+    {
+        JobSystem::runBenchmark(jobBenchmarkBatches);
+        return 0;
+    }
+    if (!convertMeshPath.empty())
+    {
+        MeshCache::convert(convertMeshPath, convertMeshLayout, convertMeshSmoothNormals);
+        return 0;
+    }
+
+    auto it = kSampleFactories.find(benchmarkConfig.sampleName);
+    if (it == kSampleFactories.end())
+    {
+        std::cerr << "Unknown sample '" << benchmarkConfig.sampleName << "'.\n";
+        printUsage();
+        return 1;
+    }
+
+    std::unique_ptr<SampleApp> project = it->second(config, benchmarkConfig);
+    return project->run();
 }
 
 int main(int argc, char** argv)
@@ -2,7 +2,7 @@
 #include "Falcor.h"
 #include "Core/SampleApp.h"
 #include "Core/Pass/RasterPass.h"
-#include <Scene/TriangleMesh.h>
+#include "MeshCache.h"
 using namespace Falcor;
 
 class ShaderSystemValue : public SampleApp
@@ -23,13 +23,12 @@ private:
     const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
     const std::string kWorldMatrices = "worldMatrices";
     static const uint kTargetCount = 6;
-    static ref<Vao> createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh);
 
     ref<Texture> mpResolvedTexture[kTargetCount];
 
-    ref<TriangleMesh> tringleMesh[3];
     ref<RasterPass> mpRasterPass;
     ref<Vao> mpVao[3];
+    std::shared_ptr<MeshCache> mpMeshCache;
     ref<Fbo> mpFbo;
     ref<ProgramVars> mpVars;
     ref<DepthStencilState> mpDepthStencil;
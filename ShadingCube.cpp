@@ -6,43 +6,6 @@ ShadingCube::ShadingCube(const SampleAppConfig& config) : SampleApp(config) {}
 
 ShadingCube::~ShadingCube() {}
 
-ref<Vao> ShadingCube::createVao(const ref<Device>& device, const ref<TriangleMesh>& mesh)
-{
-    ref<VertexLayout> pLayout = VertexLayout::create();
-
-    // Add the packed static vertex data layout.
-    ref<VertexBufferLayout> pVertexLayout = VertexBufferLayout::create();
-    pVertexLayout->addElement(
-        VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC
-    );
-    pVertexLayout->addElement(
-        VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME,
-        offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius),
-        ResourceFormat::RGB32Float,
-        1,
-        VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC
-    );
-    pVertexLayout->addElement(
-        VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC
-    );
-    pLayout->addBufferLayout(0, pVertexLayout);
-    ref<Buffer> pVertexBuffer;
-    const TriangleMesh::VertexList& vertices = mesh->getVertices();
-    uint32_t vertexCount = vertices.size();
-    ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex;
-    pVertexBuffer = device->createStructuredBuffer(
-        sizeof(PackedStaticVertexData), vertexCount, vbBindFlags, MemoryType::DeviceLocal, vertices.data(), false
-    );
-    const TriangleMesh::IndexList& indices = mesh->getIndices();
-    uint32_t indexCount = indices.size();
-    auto indexBuffer = device->createTypedBuffer<uint32_t>(
-        indexCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::Index, MemoryType::DeviceLocal, indices.data()
-    );
-
-    // Create VAO
-    return Vao::create(Vao::Topology::TriangleList, pLayout, {pVertexBuffer}, indexBuffer, ResourceFormat::R32Uint);
-}
-
 using namespace Falcor::math;
 const int kTriangleCount = 2;
 void ShadingCube::onLoad(RenderContext* pRenderContext)
@@ -52,13 +15,10 @@ void ShadingCube::onLoad(RenderContext* pRenderContext)
     mpRasterPass = RasterPass::create(device, "Samples/SampleAppTemplate/Phone.3d.slang", "vsMain", "psMain");
     mpVars = ProgramVars::create(device, mpRasterPass->getProgram()->getReflector());
 
-    trigleMesh[0] = TriangleMesh::createFromFile(getRuntimeDirectory() / "data/framework/meshes/Arcade.fbx", true);
-    trigleMesh[1] = TriangleMesh::createCube();
-    trigleMesh[2] = TriangleMesh::createSphere();
-    // Create VAO
-    mpVao[0] = createVao(device, trigleMesh[0]);
-    mpVao[1] = createVao(device, trigleMesh[1]);
-    mpVao[2] = createVao(device, trigleMesh[2]);
+    mpMeshCache = MeshCache::get(device);
+    mpVao[0] = mpMeshCache->getVao((getRuntimeDirectory() / "data/framework/meshes/Arcade.fbx").string(), MeshVertexLayout::Standard, true);
+    mpVao[1] = mpMeshCache->getVao(MeshCache::kCube, MeshVertexLayout::Standard);
+    mpVao[2] = mpMeshCache->getVao(MeshCache::kSphere, MeshVertexLayout::Standard);
 
     // Create FBO
     float height = getConfig().windowDesc.height;
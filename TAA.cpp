@@ -1,23 +1,23 @@
 #include "TAA.h"
-TAA::TAA(const SampleAppConfig& config) : GBuffer(config) {}
+TAA::TAA(const SampleAppConfig& config) : GBuffer(config)
+{
+    addTechnique(std::make_shared<TAATechnique>());
+}
 
 TAA::~TAA() {}
 
-void TAA::onLoad(RenderContext* pRenderContext)
+void TAA::loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo)
 {
-    DefineList defineList;
-    mpTAAPass = FullScreenPass::create(getDevice(), "Samples/SampleAppTemplate/TAA.slang", defineList);
-    enableJitter = true;
-    GBuffer::onLoad(pRenderContext);
+    GBuffer::loadScene("MEASURE_ONE/MEASURE_ONE.pyscene", pTargetFbo);
 }
 
-void TAA::onResize(uint32_t width, uint32_t height)
+void TAATechnique::onLoad(const ref<Device>& pDevice, TechniqueGraph& graph)
 {
-    GBuffer::onResize(width, height);
-}
+    mpDevice = pDevice;
+    DefineList defineList;
+    mpTAAPass = FullScreenPass::create(pDevice, "Samples/SampleAppTemplate/TAA.slang", defineList);
+    mpTaaFbo = Fbo::create(pDevice);
 
-void TAA::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
-{
     // (jitterX and jitterY are expressed as subpixel quantities divided by the screen resolution
     //  for instance to apply an offset of half pixel along the X axis we set jitterX = 0.5f / Width)
     // float4x4 jitterMat = math::matrixFromTranslation(float3(2.0f * mData.jitterX, 2.0f * mData.jitterY, 0.0f));
@@ -25,34 +25,39 @@ void TAA::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFb
     // mData.projMat = mul(jitterMat, mData.projMat);
     // mpCamera->setJitter(mControls.jitter / screenHeight, mControls.jitter / screenWidth);
 
-    GBuffer::onFrameRender(pRenderContext, mpFbo);
-
-    if (enableTAA)
-    {
-        allocatePrevColor(mpFbo->getColorTexture(0).get());
-        auto var = mpTAAPass->getRootVar()["taaBuf"];
-        var["tex"] = mpFbo->getColorTexture(0);
-        var["motionVectorTex"] = mpFbo->getColorTexture(5);
-        var["prevTex"] = mpPrevColor;
-        var["alpha"] = mControls.alpha;
-        var["colorBoxSigma"] = mControls.colorBoxSigma;
-        var["antiFlicker"] = mControls.antiFlicker;
-        var["reduceMotionScale"] = mControls.reduceMotionScale;
-        var["gSampler"] = gSampler;
-        //// run final pass
-        mpTAAPass->execute(pRenderContext, pTargetFbo);
-        pRenderContext->blit(pTargetFbo->getColorTexture(0)->getSRV(), mpPrevColor->getRTV());
-    }
-    else
-    {
-        pRenderContext->blit(mpFbo->getColorTexture(0)->getSRV(), pTargetFbo->getRenderTargetView(0));
-    }
+    graph.addNode({
+        "TAA",
+        {"color", "mvec"},
+        {{"color"}},
+        [this](const TechniqueGraph::FrameContext& ctx, const TechniqueGraph::NodeResources& res)
+        {
+            const ref<Texture>& pColorOut = res.getOutput("color");
+            allocatePrevColor(pColorOut.get());
+            GBuffer::updatePassDefines(mpTAAPass.get(), ctx.gbufferDefines);
+            auto var = mpTAAPass->getRootVar()["taaBuf"];
+            var["tex"] = res.getInput("color");
+            var["motionVectorTex"] = res.getInput("mvec");
+            var["prevTex"] = mpPrevColor;
+            var["alpha"] = mControls.alpha;
+            var["colorBoxSigma"] = mControls.colorBoxSigma;
+            var["antiFlicker"] = mControls.antiFlicker;
+            var["reduceMotionScale"] = mControls.reduceMotionScale;
+            var["gSampler"] = ctx.pSampler;
+            //// run final pass
+            {
+                PASS_PROFILE(ctx.pProfiler, ctx.pRenderContext, "resolve");
+                mpTaaFbo->attachColorTarget(pColorOut, 0);
+                mpTAAPass->execute(ctx.pRenderContext, mpTaaFbo);
+            }
+            PASS_PROFILE(ctx.pProfiler, ctx.pRenderContext, "copyHistory");
+            ctx.pRenderContext->blit(pColorOut->getSRV(), mpPrevColor->getRTV());
+        },
+        [this]() { return enableTAA; },
+    });
 }
 
-void TAA::onGuiRender(Gui* pGui)
+void TAATechnique::onGuiRender(Gui* pGui)
 {
-    GBuffer::onGuiRender(pGui);
-
     Gui::Window w(pGui, "TAA", {250, 500});
     w.checkbox("TAA", enableTAA);
     w.checkbox("Anti Flicker", mControls.antiFlicker);
@@ -62,11 +67,7 @@ void TAA::onGuiRender(Gui* pGui)
     w.slider("Lerp", mControls.alpha, 0.01f, 1.0f);
 }
 
-void TAA::loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo)
-{
-    GBuffer::loadScene("MEASURE_ONE/MEASURE_ONE.pyscene", pTargetFbo);
-}
-void TAA::allocatePrevColor(const Texture* pColorOut)
+void TAATechnique::allocatePrevColor(const Texture* pColorOut)
 {
     bool allocate = mpPrevColor == nullptr;
     allocate = allocate || (mpPrevColor->getWidth() != pColorOut->getWidth());
@@ -76,7 +77,7 @@ void TAA::allocatePrevColor(const Texture* pColorOut)
     FALCOR_ASSERT(pColorOut->getSampleCount() == 1);
 
     if (allocate)
-        mpPrevColor = getDevice()->createTexture2D(
+        mpPrevColor = mpDevice->createTexture2D(
             pColorOut->getWidth(),
             pColorOut->getHeight(),
             pColorOut->getFormat(),
@@ -5,21 +5,20 @@
 
 using namespace Falcor;
 
-class TAA : public GBuffer
+/// Temporal anti-aliasing, one node "TAA" (color, mvec -> color). The history is owned by the technique.
+class TAATechnique : public GBufferTechnique
 {
 public:
-    TAA(const SampleAppConfig& config);
-    ~TAA();
-
-    void onLoad(RenderContext* pRenderContext) override;
-    void onResize(uint32_t width, uint32_t height) override;
-    void onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo) override;
+    std::string getName() const override { return "TAA"; }
+    void onLoad(const ref<Device>& pDevice, TechniqueGraph& graph) override;
     void onGuiRender(Gui* pGui) override;
-    void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo) override;
+    bool needsCameraJitter() const override { return true; }
+
+    bool enableTAA = false;
 
 private:
     void allocatePrevColor(const Texture* pColorOut);
-    bool enableTAA = false;
+    ref<Device> mpDevice;
     ref<FullScreenPass> mpTAAPass;
     ref<Fbo> mpTaaFbo;
 
@@ -34,3 +33,12 @@ private:
 
     ref<Texture> mpPrevColor;
 };
+
+class TAA : public GBuffer
+{
+public:
+    TAA(const SampleAppConfig& config);
+    ~TAA();
+
+    void loadScene(const std::filesystem::path& path, const Fbo* pTargetFbo) override;
+};
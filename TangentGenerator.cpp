@@ -0,0 +1,436 @@
+#include "TangentGenerator.h"
+#include "JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TANGENT_SIMD 1
+#else
+#define TANGENT_SIMD 0
+#endif
+
+namespace
+{
+const float kDegenerateEpsilon = 1e-20f;
+// Smallest range of vertices or triangles worth a worker.
+const size_t kMinRange = 4096;
+
+struct Float3SoA
+{
+    std::vector<float> x, y, z;
+
+    void resize(size_t count)
+    {
+        x.assign(count, 0.0f);
+        y.assign(count, 0.0f);
+        z.assign(count, 0.0f);
+    }
+    float3 get(size_t i) const { return float3(x[i], y[i], z[i]); }
+    void set(size_t i, const float3& v)
+    {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+};
+
+struct MeshSoA
+{
+    Float3SoA position;
+    Float3SoA normal;
+    std::vector<float> u, v;
+};
+
+// Tangent and bitangent of a triangle, scaled by 1 / det of the UV mapping. Zero for a degenerate mapping.
+void computeTriangleTangent(const MeshSoA& mesh, const uint32_t* pIndices, float3& tangent, float3& bitangent)
+{
+    uint32_t i0 = pIndices[0], i1 = pIndices[1], i2 = pIndices[2];
+    float3 e1 = mesh.position.get(i1) - mesh.position.get(i0);
+    float3 e2 = mesh.position.get(i2) - mesh.position.get(i0);
+    float du1 = mesh.u[i1] - mesh.u[i0], du2 = mesh.u[i2] - mesh.u[i0];
+    float dv1 = mesh.v[i1] - mesh.v[i0], dv2 = mesh.v[i2] - mesh.v[i0];
+    float det = du1 * dv2 - du2 * dv1;
+    float r = std::abs(det) > kDegenerateEpsilon ? 1.0f / det : 0.0f;
+    tangent = (e1 * dv2 - e2 * dv1) * r;
+    bitangent = (e2 * du1 - e1 * du2) * r;
+}
+
+void computeTriangleTangents(const MeshSoA& mesh, const uint32_t* pIndices, size_t begin, size_t end, Float3SoA& tangents, Float3SoA& bitangents)
+{
+    for (size_t t = begin; t < end; t++)
+    {
+        float3 tangent, bitangent;
+        computeTriangleTangent(mesh, pIndices + 3 * t, tangent, bitangent);
+        tangents.set(t, tangent);
+        bitangents.set(t, bitangent);
+    }
+}
+
+#if TANGENT_SIMD
+__m128 gather(const std::vector<float>& data, const uint32_t* pIndices, uint32_t corner)
+{
+    return _mm_set_ps(data[pIndices[9 + corner]], data[pIndices[6 + corner]], data[pIndices[3 + corner]], data[pIndices[corner]]);
+}
+
+void computeTriangleTangentsSimd(const MeshSoA& mesh, const uint32_t* pIndices, size_t begin, size_t end, Float3SoA& tangents, Float3SoA& bitangents)
+{
+    const __m128 epsilon = _mm_set1_ps(kDegenerateEpsilon);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t t = begin;
+    for (; t + 4 <= end; t += 4)
+    {
+        const uint32_t* pTri = pIndices + 3 * t;
+        __m128 e1[3], e2[3];
+        const std::vector<float>* positions[3] = {&mesh.position.x, &mesh.position.y, &mesh.position.z};
+        for (int c = 0; c < 3; c++)
+        {
+            __m128 p0 = gather(*positions[c], pTri, 0);
+            e1[c] = _mm_sub_ps(gather(*positions[c], pTri, 1), p0);
+            e2[c] = _mm_sub_ps(gather(*positions[c], pTri, 2), p0);
+        }
+        __m128 u0 = gather(mesh.u, pTri, 0), v0 = gather(mesh.v, pTri, 0);
+        __m128 du1 = _mm_sub_ps(gather(mesh.u, pTri, 1), u0), du2 = _mm_sub_ps(gather(mesh.u, pTri, 2), u0);
+        __m128 dv1 = _mm_sub_ps(gather(mesh.v, pTri, 1), v0), dv2 = _mm_sub_ps(gather(mesh.v, pTri, 2), v0);
+
+        __m128 det = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+        __m128 valid = _mm_cmpgt_ps(_mm_and_ps(det, absMask), epsilon);
+        __m128 r = _mm_and_ps(valid, _mm_div_ps(one, det));
+
+        float* pTangents[3] = {&tangents.x[t], &tangents.y[t], &tangents.z[t]};
+        float* pBitangents[3] = {&bitangents.x[t], &bitangents.y[t], &bitangents.z[t]};
+        for (int c = 0; c < 3; c++)
+        {
+            __m128 tangent = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1[c], dv2), _mm_mul_ps(e2[c], dv1)), r);
+            __m128 bitangent = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e2[c], du1), _mm_mul_ps(e1[c], du2)), r);
+            _mm_storeu_ps(pTangents[c], tangent);
+            _mm_storeu_ps(pBitangents[c], bitangent);
+        }
+    }
+    computeTriangleTangents(mesh, pIndices, t, end, tangents, bitangents);
+}
+#endif
+
+// MikkTSpace weighting, per corner: the triangle frame is projected into the tangent plane of the corner's normal,
+// normalized and weighted by the corner angle.
+void computeCornerTangents(const MeshSoA& mesh, const uint32_t* pIndices, size_t begin, size_t end, Float3SoA& tangents, Float3SoA& bitangents)
+{
+    auto projectNormalized = [](const float3& v, const float3& n)
+    {
+        float3 p = v - n * math::dot(n, v);
+        float len = math::length(p);
+        return len > 1e-12f ? p / len : float3(0.0f);
+    };
+
+    for (size_t t = begin; t < end; t++)
+    {
+        const uint32_t* pTri = pIndices + 3 * t;
+        float3 tangent, bitangent;
+        computeTriangleTangent(mesh, pTri, tangent, bitangent);
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            uint32_t i = pTri[c];
+            float3 n = mesh.normal.get(i);
+            float3 p = mesh.position.get(i);
+            float3 e1 = projectNormalized(mesh.position.get(pTri[(c + 1) % 3]) - p, n);
+            float3 e2 = projectNormalized(mesh.position.get(pTri[(c + 2) % 3]) - p, n);
+            float angle = std::acos(std::clamp(math::dot(e1, e2), -1.0f, 1.0f));
+            tangents.set(3 * t + c, projectNormalized(tangent, n) * angle);
+            bitangents.set(3 * t + c, projectNormalized(bitangent, n) * angle);
+        }
+    }
+}
+
+// Compressed vertex -> corner adjacency. The corners of vertex v are corners[offsets[v], offsets[v + 1]).
+struct VertexCorners
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> corners;
+
+    VertexCorners(const TriangleMesh::IndexList& indices, size_t vertexCount)
+    {
+        offsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : indices)
+            offsets[index + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+        corners.resize(indices.size());
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32_t c = 0; c < indices.size(); c++)
+            corners[cursor[indices[c]]++] = c;
+    }
+};
+
+void orthonormalize(const float3& n, float3 t, const float3& b, float3& tangent, float3& bitangent)
+{
+    t = t - n * math::dot(n, t);
+    float len2 = math::dot(t, t);
+    if (len2 < 1e-24f)
+    {
+        t = std::abs(n.x) < 0.9f ? float3(0.0f, n.z, -n.y) : float3(-n.z, 0.0f, n.x);
+        len2 = math::dot(t, t);
+    }
+    t = t / std::sqrt(len2);
+    float3 c = math::cross(n, t);
+    tangent = t;
+    bitangent = math::dot(c, b) < 0.0f ? -c : c;
+}
+
+void orthonormalizeRange(
+    const MeshSoA& mesh,
+    const Float3SoA& accT,
+    const Float3SoA& accB,
+    size_t begin,
+    size_t end,
+    std::vector<float3>& tangents,
+    std::vector<float3>& bitangents
+)
+{
+    for (size_t v = begin; v < end; v++)
+        orthonormalize(mesh.normal.get(v), accT.get(v), accB.get(v), tangents[v], bitangents[v]);
+}
+
+#if TANGENT_SIMD
+void orthonormalizeRangeSimd(
+    const MeshSoA& mesh,
+    const Float3SoA& accT,
+    const Float3SoA& accB,
+    size_t begin,
+    size_t end,
+    std::vector<float3>& tangents,
+    std::vector<float3>& bitangents
+)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 zero = _mm_setzero_ps();
+    auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+    size_t v = begin;
+    for (; v + 4 <= end; v += 4)
+    {
+        __m128 nx = _mm_loadu_ps(&mesh.normal.x[v]), ny = _mm_loadu_ps(&mesh.normal.y[v]), nz = _mm_loadu_ps(&mesh.normal.z[v]);
+        __m128 tx = _mm_loadu_ps(&accT.x[v]), ty = _mm_loadu_ps(&accT.y[v]), tz = _mm_loadu_ps(&accT.z[v]);
+        __m128 bx = _mm_loadu_ps(&accB.x[v]), by = _mm_loadu_ps(&accB.y[v]), bz = _mm_loadu_ps(&accB.z[v]);
+
+        // Gram-Schmidt
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, tx), _mm_mul_ps(ny, ty)), _mm_mul_ps(nz, tz));
+        tx = _mm_sub_ps(tx, _mm_mul_ps(nx, d));
+        ty = _mm_sub_ps(ty, _mm_mul_ps(ny, d));
+        tz = _mm_sub_ps(tz, _mm_mul_ps(nz, d));
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+
+        // Fallback for vertices without a tangent: cross(n, x) or cross(n, y).
+        __m128 degenerate = _mm_cmplt_ps(len2, _mm_set1_ps(1e-24f));
+        __m128 useX = _mm_cmplt_ps(_mm_and_ps(nx, absMask), _mm_set1_ps(0.9f));
+        __m128 fx = select(useX, zero, _mm_xor_ps(nz, signMask));
+        __m128 fy = select(useX, nz, zero);
+        __m128 fz = select(useX, _mm_xor_ps(ny, signMask), nx);
+        tx = select(degenerate, fx, tx);
+        ty = select(degenerate, fy, ty);
+        tz = select(degenerate, fz, tz);
+        len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz));
+
+        __m128 rcpLen = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2));
+        tx = _mm_mul_ps(tx, rcpLen);
+        ty = _mm_mul_ps(ty, rcpLen);
+        tz = _mm_mul_ps(tz, rcpLen);
+
+        // Handedness: flip the bitangent when cross(n, t) points away from the accumulated one.
+        __m128 cx = _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty));
+        __m128 cy = _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz));
+        __m128 cz = _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx));
+        __m128 h = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, bx), _mm_mul_ps(cy, by)), _mm_mul_ps(cz, bz));
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(h, zero), signMask);
+        cx = _mm_xor_ps(cx, flip);
+        cy = _mm_xor_ps(cy, flip);
+        cz = _mm_xor_ps(cz, flip);
+
+        alignas(16) float out[6][4];
+        _mm_store_ps(out[0], tx);
+        _mm_store_ps(out[1], ty);
+        _mm_store_ps(out[2], tz);
+        _mm_store_ps(out[3], cx);
+        _mm_store_ps(out[4], cy);
+        _mm_store_ps(out[5], cz);
+        for (int i = 0; i < 4; i++)
+        {
+            tangents[v + i] = float3(out[0][i], out[1][i], out[2][i]);
+            bitangents[v + i] = float3(out[3][i], out[4][i], out[5][i]);
+        }
+    }
+    orthonormalizeRange(mesh, accT, accB, v, end, tangents, bitangents);
+}
+#endif
+
+TriangleMesh::VertexList createBenchmarkMesh(uint32_t triangleCount, TriangleMesh::IndexList& indices)
+{
+    uint32_t quads = std::max(1u, (uint32_t)std::sqrt(triangleCount / 2.0));
+    uint32_t side = quads + 1;
+    TriangleMesh::VertexList vertices(side * side);
+    for (uint32_t y = 0; y < side; y++)
+    {
+        for (uint32_t x = 0; x < side; x++)
+        {
+            float fx = (float)x / quads, fy = (float)y / quads;
+            float h = 0.05f * std::sin(40.0f * fx) * std::cos(30.0f * fy);
+            float3 n = math::normalize(float3(-2.0f * std::cos(40.0f * fx) * std::cos(30.0f * fy), 1.0f, 1.5f * std::sin(40.0f * fx) * std::sin(30.0f * fy)));
+            // Mirror the UVs in one half to exercise the handedness flip.
+            vertices[y * side + x] = {float3(fx, h, fy), n, float2(fx < 0.5f ? fx : 1.0f - fx, fy)};
+        }
+    }
+    indices.clear();
+    indices.reserve(quads * quads * 6);
+    for (uint32_t y = 0; y < quads; y++)
+    {
+        for (uint32_t x = 0; x < quads; x++)
+        {
+            uint32_t i = y * side + x;
+            indices.insert(indices.end(), {i, i + side, i + 1, i + 1, i + side, i + side + 1});
+        }
+    }
+    return vertices;
+}
+} // namespace
+
+void TangentGenerator::generate(
+    const TriangleMesh::VertexList& vertices,
+    const TriangleMesh::IndexList& indices,
+    std::vector<float3>& tangents,
+    std::vector<float3>& bitangents,
+    const TangentOptions& options
+)
+{
+    size_t vertexCount = vertices.size();
+    size_t triangleCount = indices.size() / 3;
+    // Ranges start at multiples of 4, so the SIMD loops only have a tail in the last range.
+    auto parallelFor = [&](size_t count, const auto& func)
+    { JobSystem::get().parallelFor(count, options.threadCount, kMinRange, 4, func); };
+    bool simd = TANGENT_SIMD && options.simd;
+
+    MeshSoA mesh;
+    mesh.position.resize(vertexCount);
+    mesh.normal.resize(vertexCount);
+    mesh.u.resize(vertexCount);
+    mesh.v.resize(vertexCount);
+    parallelFor(
+        vertexCount,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                mesh.position.set(i, vertices[i].position);
+                mesh.normal.set(i, vertices[i].normal);
+                mesh.u[i] = vertices[i].texCoord.x;
+                mesh.v[i] = vertices[i].texCoord.y;
+            }
+        }
+    );
+
+    // Contributions, per triangle for Accumulate and per corner for MikkTSpace.
+    bool perCorner = options.method == TangentMethod::MikkTSpace;
+    Float3SoA contribT, contribB;
+    contribT.resize(perCorner ? indices.size() : triangleCount);
+    contribB.resize(perCorner ? indices.size() : triangleCount);
+    parallelFor(
+        triangleCount,
+        [&](size_t begin, size_t end)
+        {
+            if (perCorner)
+                computeCornerTangents(mesh, indices.data(), begin, end, contribT, contribB);
+#if TANGENT_SIMD
+            else if (simd)
+                computeTriangleTangentsSimd(mesh, indices.data(), begin, end, contribT, contribB);
+#endif
+            else
+                computeTriangleTangents(mesh, indices.data(), begin, end, contribT, contribB);
+        }
+    );
+
+    // Gather instead of scattering, so that threads never write the same vertex.
+    VertexCorners adjacency(indices, vertexCount);
+    Float3SoA accT, accB;
+    accT.resize(vertexCount);
+    accB.resize(vertexCount);
+    parallelFor(
+        vertexCount,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t v = begin; v < end; v++)
+            {
+                float3 t(0.0f), b(0.0f);
+                for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; i++)
+                {
+                    uint32_t c = adjacency.corners[i];
+                    uint32_t source = perCorner ? c : c / 3;
+                    t += contribT.get(source);
+                    b += contribB.get(source);
+                }
+                accT.set(v, t);
+                accB.set(v, b);
+            }
+        }
+    );
+
+    tangents.resize(vertexCount);
+    bitangents.resize(vertexCount);
+    parallelFor(
+        vertexCount,
+        [&](size_t begin, size_t end)
+        {
+#if TANGENT_SIMD
+            if (simd)
+            {
+                orthonormalizeRangeSimd(mesh, accT, accB, begin, end, tangents, bitangents);
+                return;
+            }
+#endif
+            orthonormalizeRange(mesh, accT, accB, begin, end, tangents, bitangents);
+        }
+    );
+}
+
+void TangentGenerator::runBenchmark(uint32_t triangleCount)
+{
+    const uint32_t kIterations = 5;
+
+    TriangleMesh::IndexList indices;
+    TriangleMesh::VertexList vertices = createBenchmarkMesh(triangleCount, indices);
+
+    auto measure = [&](const TangentOptions& options, std::vector<float3>& tangents)
+    {
+        std::vector<float3> bitangents;
+        double best = std::numeric_limits<double>::max();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            generate(vertices, indices, tangents, bitangents, options);
+            best = std::min(best, CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()));
+        }
+        return best;
+    };
+
+    std::vector<float3> reference, simdTangents, mikkTangents;
+    double scalarMs = measure({TangentMethod::Accumulate, false, 1}, reference);
+    double simdMs = measure({TangentMethod::Accumulate, true, 1}, simdTangents);
+    double parallelMs = measure({TangentMethod::Accumulate, true, 0}, simdTangents);
+    double mikkMs = measure({TangentMethod::MikkTSpace, true, 0}, mikkTangents);
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < reference.size(); i++)
+        maxError = std::max(maxError, math::length(reference[i] - simdTangents[i]));
+
+    logInfo(
+        "Tangent benchmark, {} vertices, {} triangles, best of {}: scalar {:.2f} ms, SIMD {:.2f} ms, SIMD + {} threads {:.2f} ms, "
+        "MikkTSpace weighting {:.2f} ms. Max SIMD deviation {:.2e}.",
+        vertices.size(),
+        indices.size() / 3,
+        kIterations,
+        scalarMs,
+        simdMs,
+        JobSystem::get().getThreadCount() + 1,
+        parallelMs,
+        mikkMs,
+        maxError
+    );
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Falcor.h"
+#include <Scene/TriangleMesh.h>
+
+using namespace Falcor;
+
+enum class TangentMethod
+{
+    /// Sum of the unnormalized triangle tangents (Lengyel), large triangles weigh more.
+    Accumulate,
+    /// Weighting of MikkTSpace: triangle tangents are projected into the plane of each corner's vertex normal,
+    /// normalized and weighted by the corner angle. Vertices are not split at mirrored UVs as MikkTSpace does,
+    /// because the meshes are indexed already.
+    MikkTSpace,
+};
+
+struct TangentOptions
+{
+    TangentMethod method = TangentMethod::Accumulate;
+    bool simd = true;
+    uint32_t threadCount = 0; ///< Threads per step, the caller's included. 0 uses all JobSystem workers.
+};
+
+/** Per-vertex tangent frames for normal mapping.
+    Positions, normals and texture coordinates are first copied into structure-of-arrays form. Triangle tangents
+    are then computed 4 triangles per SSE instruction and gathered into the vertices. Finally the accumulated frames
+    are orthonormalized against the vertex normals 4 vertices at a time. Every step is split across the JobSystem workers.
+    Triangles with a degenerate UV mapping contribute nothing; vertices without any contribution get an arbitrary
+    tangent perpendicular to the normal.
+    Output convention: the tangent follows dP/du and the bitangent is cross(normal, tangent), negated where the UVs
+    are mirrored. The sign is the handedness of the frame the shaders need to follow dP/dv.
+ */
+class TangentGenerator
+{
+public:
+    static void generate(
+        const TriangleMesh::VertexList& vertices,
+        const TriangleMesh::IndexList& indices,
+        std::vector<float3>& tangents,
+        std::vector<float3>& bitangents,
+        const TangentOptions& options = {}
+    );
+
+    /// Times the scalar single-threaded path against the SIMD multithreaded paths on a procedural mesh of about
+    /// `triangleCount` triangles and logs the results.
+    static void runBenchmark(uint32_t triangleCount);
+};
@@ -0,0 +1,275 @@
+#include "TechniqueGraph.h"
+
+const ref<Texture>& TechniqueGraph::NodeResources::find(const List& list, const std::string& name)
+{
+    for (const auto& [resourceName, pTexture] : list)
+    {
+        if (resourceName == name)
+            return pTexture;
+    }
+    FALCOR_THROW("TechniqueGraph: the node did not declare the resource '{}'.", name);
+}
+
+void TechniqueGraph::addNode(NodeDesc desc)
+{
+    for (const auto& output : desc.outputs)
+    {
+        if (output.format == ResourceFormat::Unknown && desc.inputs.empty())
+            FALCOR_THROW("TechniqueGraph: node '{}' has no input to take the format of its output '{}' from.", desc.name, output.name);
+    }
+    mNodes.push_back({std::move(desc)});
+    mDirty = true;
+}
+
+void TechniqueGraph::importTexture(const std::string& name, const ref<Texture>& pTexture)
+{
+    auto [it, inserted] = mImports.insert_or_assign(name, pTexture);
+    // Whether the texture is null is checked when it is read, only new names change the graph.
+    mDirty |= inserted;
+}
+
+void TechniqueGraph::setOutputScale(const std::string& name, float scale)
+{
+    // Sizes are only used when the outputs are allocated, the graph itself does not change.
+    for (auto& node : mNodes)
+    {
+        for (auto& output : node.desc.outputs)
+        {
+            if (output.name == name)
+                output.scale = scale;
+        }
+    }
+}
+
+void TechniqueGraph::setOutput(const std::string& name)
+{
+    mDirty |= name != mOutput;
+    mOutput = name;
+}
+
+std::vector<std::string> TechniqueGraph::getResourceNames() const
+{
+    std::vector<std::string> names;
+    auto add = [&](const std::string& name)
+    {
+        if (std::find(names.begin(), names.end(), name) == names.end())
+            names.push_back(name);
+    };
+    for (const auto& [name, pTexture] : mImports)
+        add(name);
+    for (const auto& node : mNodes)
+    {
+        if (!node.enabled)
+            continue;
+        for (const auto& output : node.desc.outputs)
+            add(output.name);
+    }
+    return names;
+}
+
+void TechniqueGraph::update()
+{
+    for (auto& node : mNodes)
+    {
+        bool enabled = !node.desc.isEnabled || node.desc.isEnabled();
+        mDirty |= enabled != node.enabled;
+        node.enabled = enabled;
+    }
+    if (mDirty)
+        compile();
+}
+
+void TechniqueGraph::compile()
+{
+    mVersions.clear();
+    mSchedule.clear();
+    mReadImports.clear();
+
+    // Resolve every read to the latest write of its resource before the reader.
+    std::map<std::string, uint32_t> latest;
+    auto resolve = [&](const std::string& name) -> std::optional<uint32_t>
+    {
+        auto it = latest.find(name);
+        if (it != latest.end())
+            return it->second;
+        if (mImports.count(name) == 0)
+            return std::nullopt;
+        mVersions.push_back({name, kImported, 0});
+        latest[name] = (uint32_t)mVersions.size() - 1;
+        return latest[name];
+    };
+
+    for (uint32_t i = 0; i < mNodes.size(); i++)
+    {
+        Node& node = mNodes[i];
+        node.live = false;
+        node.inputVersions.clear();
+        node.outputVersions.clear();
+        if (!node.enabled)
+            continue;
+        for (const auto& input : node.desc.inputs)
+        {
+            auto version = resolve(input);
+            if (!version)
+                FALCOR_THROW("TechniqueGraph: node '{}' reads '{}', which is neither imported nor written by an earlier node.", node.desc.name, input);
+            node.inputVersions.push_back(*version);
+        }
+        for (const auto& output : node.desc.outputs)
+        {
+            mVersions.push_back({output.name, i, 0});
+            node.outputVersions.push_back((uint32_t)mVersions.size() - 1);
+            latest[output.name] = node.outputVersions.back();
+        }
+    }
+
+    auto output = resolve(mOutput);
+    if (!output)
+    {
+        logWarning("TechniqueGraph: nothing provides '{}', presenting 'color' instead.", mOutput);
+        output = resolve("color");
+        if (!output)
+            FALCOR_THROW("TechniqueGraph: nothing provides 'color'.");
+    }
+    mOutputVersion = *output;
+
+    // Walk back from the output. Writers come before their readers, so a single reverse pass finds every live node.
+    std::vector<bool> versionLive(mVersions.size(), false);
+    versionLive[mOutputVersion] = true;
+    for (uint32_t i = (uint32_t)mNodes.size(); i-- > 0;)
+    {
+        Node& node = mNodes[i];
+        if (!node.enabled)
+            continue;
+        for (uint32_t version : node.outputVersions)
+            node.live |= versionLive[version];
+        if (node.live)
+        {
+            for (uint32_t version : node.inputVersions)
+                versionLive[version] = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < mNodes.size(); i++)
+    {
+        const Node& node = mNodes[i];
+        if (!node.live)
+            continue;
+        uint32_t position = (uint32_t)mSchedule.size();
+        mSchedule.push_back(i);
+        // Outputs nobody reads are released right after the node.
+        for (uint32_t version : node.outputVersions)
+            mVersions[version].lastReader = position;
+        for (uint32_t version : node.inputVersions)
+            mVersions[version].lastReader = position;
+    }
+    mVersions[mOutputVersion].lastReader = kPresent;
+
+    for (uint32_t version = 0; version < mVersions.size(); version++)
+    {
+        if (mVersions[version].producer == kImported && versionLive[version])
+            mReadImports.push_back(mVersions[version].name);
+    }
+    mTextures.assign(mVersions.size(), nullptr);
+    mDirty = false;
+}
+
+void TechniqueGraph::execute(const FrameContext& ctx, const ref<Fbo>& pTargetFbo)
+{
+    update();
+
+    RenderContext* pRenderContext = ctx.pRenderContext;
+    mTexturePool.beginFrame();
+    for (uint32_t version = 0; version < mVersions.size(); version++)
+    {
+        if (mVersions[version].producer == kImported)
+            mTextures[version] = mImports.at(mVersions[version].name);
+    }
+
+    auto releaseAfter = [&](uint32_t version, uint32_t position)
+    {
+        if (mVersions[version].producer != kImported && mVersions[version].lastReader == position)
+        {
+            mTexturePool.release(mTextures[version]);
+            mTextures[version] = nullptr;
+        }
+    };
+
+    for (uint32_t position = 0; position < mSchedule.size(); position++)
+    {
+        const Node& node = mNodes[mSchedule[position]];
+        NodeResources resources;
+        for (size_t j = 0; j < node.inputVersions.size(); j++)
+        {
+            const ref<Texture>& pTexture = mTextures[node.inputVersions[j]];
+            if (!pTexture)
+                FALCOR_THROW("TechniqueGraph: node '{}' reads '{}', which is not available.", node.desc.name, node.desc.inputs[j]);
+            pRenderContext->resourceBarrier(pTexture.get(), Resource::State::ShaderResource);
+            resources.mInputs.emplace_back(node.desc.inputs[j], pTexture);
+        }
+        for (size_t j = 0; j < node.outputVersions.size(); j++)
+        {
+            const OutputDesc& output = node.desc.outputs[j];
+            ResourceFormat format = output.format;
+            if (format == ResourceFormat::Unknown)
+            {
+                auto it = std::find(node.desc.inputs.begin(), node.desc.inputs.end(), output.name);
+                format = resources.mInputs[it != node.desc.inputs.end() ? it - node.desc.inputs.begin() : 0].second->getFormat();
+            }
+            uint2 dim = uint2(
+                std::max(1u, (uint32_t)std::lround(ctx.renderDim.x * output.scale)),
+                std::max(1u, (uint32_t)std::lround(ctx.renderDim.y * output.scale))
+            );
+            ref<Texture> pTexture = mTexturePool.acquire(dim.x, dim.y, format, output.bindFlags);
+            Resource::State state = is_set(output.bindFlags, ResourceBindFlags::UnorderedAccess) ? Resource::State::UnorderedAccess
+                                                                                                  : Resource::State::RenderTarget;
+            pRenderContext->resourceBarrier(pTexture.get(), state);
+            mTextures[node.outputVersions[j]] = pTexture;
+            resources.mOutputs.emplace_back(output.name, pTexture);
+        }
+
+        {
+            PASS_PROFILE(ctx.pProfiler, pRenderContext, node.desc.name);
+            node.desc.execute(ctx, resources);
+        }
+
+        for (uint32_t version : node.inputVersions)
+            releaseAfter(version, position);
+        for (uint32_t version : node.outputVersions)
+            releaseAfter(version, position);
+    }
+
+    const ref<Texture>& pOutput = mTextures[mOutputVersion];
+    if (!pOutput)
+        FALCOR_THROW("TechniqueGraph: the output '{}' is not available.", mVersions[mOutputVersion].name);
+    pRenderContext->blit(pOutput->getSRV(), pTargetFbo->getRenderTargetView(0));
+    if (mVersions[mOutputVersion].producer != kImported)
+        mTexturePool.release(pOutput);
+    std::fill(mTextures.begin(), mTextures.end(), nullptr);
+}
+
+void TechniqueGraph::renderUI(Gui::Widgets& widget)
+{
+    std::vector<std::string> names = getResourceNames();
+    Gui::DropdownList outputList;
+    uint32_t selected = 0;
+    for (uint32_t i = 0; i < names.size(); i++)
+    {
+        outputList.push_back({i, names[i]});
+        if (names[i] == mOutput)
+            selected = i;
+    }
+    if (widget.dropdown("Output", outputList, selected))
+        setOutput(names[selected]);
+
+    for (const auto& node : mNodes)
+        widget.text(fmt::format("{}: {}", node.desc.name, node.live ? "live" : node.enabled ? "culled" : "disabled"));
+    std::string reads;
+    for (const auto& name : mReadImports)
+        reads += (reads.empty() ? "" : ", ") + name;
+    widget.text("G-buffer reads: " + reads);
+    widget.text(fmt::format(
+        "Transient targets: {} textures, {:.1f} MB",
+        mTexturePool.getTextureCount(),
+        mTexturePool.getAllocatedBytes() / (1024.0 * 1024.0)
+    ));
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "Falcor.h"
+#include "PassProfiler.h"
+#include "TransientTexturePool.h"
+
+using namespace Falcor;
+
+/** Declarative frame graph of the screen-space techniques built on the G-buffer.
+    Every node names the resources it reads and the ones it writes. Imported resources (the G-buffer channels under
+    their ChannelDesc names, and "depth") and node outputs share one namespace. A node reading "color" sees the latest
+    "color" written by an enabled node added before it, or the import if there is none. A node can therefore
+    read and write "color" to extend the chain, and disabled nodes simply drop out of it.
+    Compiling the graph:
+    - culls the nodes that do not contribute to the presented output, along with the imports only they read;
+    - computes the lifetime of every node output.
+    execute() runs the live nodes in the order they were added:
+    - it transitions their inputs and outputs before each node runs;
+    - it allocates outputs from a TransientTexturePool and releases them after their last reader, so outputs
+      with disjoint lifetimes share memory;
+    - it blits the output resource to the target.
+ */
+class TechniqueGraph
+{
+public:
+    struct OutputDesc
+    {
+        std::string name;
+        /// 'Unknown' takes the format of the node's input of the same name, or of its first input.
+        ResourceFormat format = ResourceFormat::Unknown;
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::RenderTarget;
+        /// Size relative to the render resolution.
+        float scale = 1.0f;
+    };
+
+    /// Per-frame data shared by all nodes.
+    struct FrameContext
+    {
+        RenderContext* pRenderContext = nullptr;
+        const Camera* pCamera = nullptr;
+        ref<Sampler> pSampler;
+        PassProfiler* pProfiler = nullptr;
+        /// Defines of the current G-buffer layout, for the passes that decode G-buffer channels.
+        DefineList gbufferDefines;
+        uint2 renderDim = {};
+        uint32_t frameIndex = 0;
+    };
+
+    /// Textures bound to a node for one execution.
+    class NodeResources
+    {
+    public:
+        const ref<Texture>& getInput(const std::string& name) const { return find(mInputs, name); }
+        const ref<Texture>& getOutput(const std::string& name) const { return find(mOutputs, name); }
+
+    private:
+        friend class TechniqueGraph;
+        using List = std::vector<std::pair<std::string, ref<Texture>>>;
+        static const ref<Texture>& find(const List& list, const std::string& name);
+        List mInputs;
+        List mOutputs;
+    };
+
+    using ExecuteFunc = std::function<void(const FrameContext&, const NodeResources&)>;
+    using EnabledFunc = std::function<bool()>;
+
+    struct NodeDesc
+    {
+        std::string name; ///< Also the scope of the node in the pass timings.
+        std::vector<std::string> inputs;
+        std::vector<OutputDesc> outputs;
+        ExecuteFunc execute;
+        EnabledFunc isEnabled; ///< Evaluated every frame, null for always enabled.
+    };
+
+    TechniqueGraph(const ref<Device>& pDevice) : mTexturePool(pDevice) {}
+
+    void addNode(NodeDesc desc);
+    /** Makes a texture the graph does not own available to the nodes under `name`, replacing any previous import.
+        A null texture marks the resource as unavailable, e.g. a channel the G-buffer layout does not store.
+    */
+    void importTexture(const std::string& name, const ref<Texture>& pTexture);
+    /// Changes the scale of every node output called `name`, e.g. for a technique with a quality setting.
+    void setOutputScale(const std::string& name, float scale);
+    /// Resource presented by execute(), "color" by default. Falls back to "color" while nothing provides it.
+    void setOutput(const std::string& name);
+    const std::string& getOutput() const { return mOutput; }
+
+    /// Re-evaluates the enabled nodes and recompiles the graph if they or the output changed. Called by execute().
+    void update();
+    void execute(const FrameContext& ctx, const ref<Fbo>& pTargetFbo);
+
+    /// Imports read by the live nodes, as of the last update().
+    const std::vector<std::string>& getReadImports() const { return mReadImports; }
+    /// Imports and outputs of the enabled nodes, whether live or not, in order of first appearance.
+    std::vector<std::string> getResourceNames() const;
+    void renderUI(Gui::Widgets& widget);
+
+private:
+    struct Node
+    {
+        NodeDesc desc;
+        bool enabled = false;
+        bool live = false;
+        std::vector<uint32_t> inputVersions;
+        std::vector<uint32_t> outputVersions;
+    };
+
+    /// One write of a resource, or its import.
+    struct Version
+    {
+        std::string name;
+        uint32_t producer; ///< Index of the writing node, kImported for imports.
+        uint32_t lastReader; ///< Position in mSchedule of the last live reader, kPresent if it is presented.
+    };
+
+    static const uint32_t kImported = ~0u;
+    static const uint32_t kPresent = ~0u - 1;
+
+    void compile();
+
+    std::vector<Node> mNodes;
+    std::map<std::string, ref<Texture>> mImports;
+    std::string mOutput = "color";
+    bool mDirty = true;
+
+    std::vector<Version> mVersions;
+    std::vector<uint32_t> mSchedule; ///< Live nodes in execution order.
+    uint32_t mOutputVersion = 0;
+    std::vector<std::string> mReadImports;
+    std::vector<ref<Texture>> mTextures; ///< Texture of every version while the graph executes.
+
+    TransientTexturePool mTexturePool;
+};
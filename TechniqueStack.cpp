@@ -0,0 +1,25 @@
+#include "TechniqueStack.h"
+#include "SSAO.h"
+#include "SSR.h"
+#include "TAA.h"
+#include "FXAA.h"
+
+TechniqueStack::TechniqueStack(const SampleAppConfig& config) : GBuffer(config)
+{
+    // Each technique keeps its own toggle in its window, all of them start enabled.
+    auto pSSAO = std::make_shared<SSAOTechnique>();
+    pSSAO->enableSSAO = true;
+    auto pSSR = std::make_shared<SSRTechnique>();
+    pSSR->enableSSR = true;
+    auto pTAA = std::make_shared<TAATechnique>();
+    pTAA->enableTAA = true;
+    auto pFXAA = std::make_shared<FXAATechnique>();
+    pFXAA->enableFXAA = true;
+
+    addTechnique(pSSAO);
+    addTechnique(pSSR);
+    addTechnique(pTAA);
+    addTechnique(pFXAA);
+}
+
+TechniqueStack::~TechniqueStack() {}
@@ -0,0 +1,13 @@
+#pragma once
+#include "Falcor.h"
+#include "GBuffer.h"
+
+using namespace Falcor;
+
+/// Runs SSAO, SSR, TAA and FXAA in one frame, in that order, to measure the cost of the combined stack.
+class TechniqueStack : public GBuffer
+{
+public:
+    TechniqueStack(const SampleAppConfig& config);
+    ~TechniqueStack();
+};
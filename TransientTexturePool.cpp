@@ -0,0 +1,48 @@
+#include "TransientTexturePool.h"
+
+void TransientTexturePool::beginFrame()
+{
+    mFrame++;
+    for (auto it = mFreeTextures.begin(); it != mFreeTextures.end();)
+    {
+        auto& freeList = it->second;
+        for (size_t i = 0; i < freeList.size();)
+        {
+            if (mFrame - freeList[i].releaseFrame > kMaxIdleFrames)
+            {
+                mTextureCount--;
+                mAllocatedBytes -= getTextureBytes(it->first);
+                freeList[i] = std::move(freeList.back());
+                freeList.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+        it = freeList.empty() ? mFreeTextures.erase(it) : std::next(it);
+    }
+}
+
+ref<Texture> TransientTexturePool::acquire(uint32_t width, uint32_t height, ResourceFormat format, ResourceBindFlags bindFlags)
+{
+    Key key{width, height, format, bindFlags};
+    auto it = mFreeTextures.find(key);
+    if (it != mFreeTextures.end() && !it->second.empty())
+    {
+        ref<Texture> pTexture = std::move(it->second.back().pTexture);
+        it->second.pop_back();
+        return pTexture;
+    }
+
+    mTextureCount++;
+    mAllocatedBytes += getTextureBytes(key);
+    return mpDevice->createTexture2D(width, height, format, 1, 1, nullptr, bindFlags);
+}
+
+void TransientTexturePool::release(const ref<Texture>& pTexture)
+{
+    FALCOR_ASSERT(pTexture);
+    Key key{pTexture->getWidth(), pTexture->getHeight(), pTexture->getFormat(), pTexture->getBindFlags()};
+    mFreeTextures[key].push_back({pTexture, mFrame});
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** Frame-scoped pool of 2D render targets.
+    Textures are keyed by (size, format, bind flags). A released texture goes back to its free list and is handed
+    out again by the next matching acquire(), so a chain that releases its input after acquiring its output
+    ping-pongs between two textures no matter how long it is.
+    Free textures that have not been reused for kMaxIdleFrames frames are destroyed, which drops targets of an
+    old resolution after a resize.
+ */
+class TransientTexturePool
+{
+public:
+    static const uint32_t kMaxIdleFrames = 4;
+
+    TransientTexturePool(const ref<Device>& pDevice) : mpDevice(pDevice) {}
+
+    /// Evicts idle textures. Call once per frame before the first acquire().
+    void beginFrame();
+    ref<Texture> acquire(uint32_t width, uint32_t height, ResourceFormat format, ResourceBindFlags bindFlags);
+    void release(const ref<Texture>& pTexture);
+
+    /// Number of textures owned by the pool, both in use and free.
+    uint32_t getTextureCount() const { return mTextureCount; }
+    uint64_t getAllocatedBytes() const { return mAllocatedBytes; }
+
+private:
+    struct Key
+    {
+        uint32_t width;
+        uint32_t height;
+        ResourceFormat format;
+        ResourceBindFlags bindFlags;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(width, height, format, bindFlags) < std::tie(other.width, other.height, other.format, other.bindFlags);
+        }
+    };
+
+    struct FreeTexture
+    {
+        ref<Texture> pTexture;
+        uint64_t releaseFrame;
+    };
+
+    static uint64_t getTextureBytes(const Key& key) { return (uint64_t)key.width * key.height * getFormatBytesPerBlock(key.format); }
+
+    ref<Device> mpDevice;
+    std::map<Key, std::vector<FreeTexture>> mFreeTextures;
+    uint64_t mFrame = 0;
+    uint32_t mTextureCount = 0;
+    uint64_t mAllocatedBytes = 0;
+};